@@ -33,25 +33,60 @@
 extern UART_HandleTypeDef huart1;
 
 static void elog_entry(void *para);
+
+#define ELOG_TASK_STACK_SIZE (128 * 4)
+
+#ifdef ELOG_PORT_STATIC_ALLOC
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+/* static storage for the task and semaphores, nothing is taken from the heap */
+static StaticTask_t elogTask_cb;
+static StackType_t elogTask_stack[ELOG_TASK_STACK_SIZE / sizeof(StackType_t)];
+static StaticSemaphore_t elog_lock_cb;
+static StaticSemaphore_t elog_async_cb;
+static StaticSemaphore_t elog_dma_lock_cb;
+#endif
+
 /* Definitions for elog */
 osThreadId_t elogTaskHandle;
 const osThreadAttr_t elogTask_attributes = {
     .name = "elogTask",
-    .stack_size = 128 * 4,
+#ifdef ELOG_PORT_STATIC_ALLOC
+    .cb_mem = &elogTask_cb,
+    .cb_size = sizeof(elogTask_cb),
+    .stack_mem = elogTask_stack,
+#endif
+    .stack_size = ELOG_TASK_STACK_SIZE,
     .priority = (osPriority_t)osPriorityLow,
 };
 /* Definitions for elog_lock */
 osSemaphoreId_t elog_lockHandle;
 const osSemaphoreAttr_t elog_lock_attributes = {
-    .name = "elog_lock"};
+    .name = "elog_lock",
+#ifdef ELOG_PORT_STATIC_ALLOC
+    .cb_mem = &elog_lock_cb,
+    .cb_size = sizeof(elog_lock_cb),
+#endif
+};
 /* Definitions for elog_async */
 osSemaphoreId_t elog_asyncHandle;
 const osSemaphoreAttr_t elog_async_attributes = {
-    .name = "elog_async"};
+    .name = "elog_async",
+#ifdef ELOG_PORT_STATIC_ALLOC
+    .cb_mem = &elog_async_cb,
+    .cb_size = sizeof(elog_async_cb),
+#endif
+};
 /* Definitions for elog_dma_lock */
 osSemaphoreId_t elog_dma_lockHandle;
 const osSemaphoreAttr_t elog_dma_lock_attributes = {
-    .name = "elog_dma_lock"};
+    .name = "elog_dma_lock",
+#ifdef ELOG_PORT_STATIC_ALLOC
+    .cb_mem = &elog_dma_lock_cb,
+    .cb_size = sizeof(elog_dma_lock_cb),
+#endif
+};
 
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
 {
@@ -77,6 +77,10 @@
 /* asynchronous output mode using POSIX pthread implementation */
 // #define ELOG_ASYNC_OUTPUT_USING_PTHREAD
 /*---------------------------------------------------------------------------*/
+/* port: create the log task and semaphores from static storage instead of the FreeRTOS heap */
+/* (requires configSUPPORT_STATIC_ALLOCATION) */
+// #define ELOG_PORT_STATIC_ALLOC
+/*---------------------------------------------------------------------------*/
 /* enable buffered output mode */
 // #define ELOG_BUF_OUTPUT_ENABLE
 /* buffer size for buffered output mode */
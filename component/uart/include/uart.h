@@ -1,40 +1,165 @@
 #pragma once
+#include "stdbool.h"
 #include "stddef.h"
 #include "stdint.h"
 
 #include "esp_err.h"
+#include "worker.h"
 
-// 前向声明FreeRTOS类型
-#ifndef INC_FREERTOS_H
-typedef uint32_t TickType_t;
+// 静态分配模式：环形缓冲区和互斥锁使用静态存储，不从FreeRTOS堆分配
+// （需要configSUPPORT_STATIC_ALLOCATION=1）
+#ifndef UART_STATIC_ALLOC
+#define UART_STATIC_ALLOC 0
+#endif
+
+// 静态缓冲区所在的段（可定义为FASTDATA）
+#ifndef UART_STATIC_SECTION
+#define UART_STATIC_SECTION
+#endif
+
+// 每个端口环形DMA接收缓冲区的大小（字节，偶数）
+// DMA在半满、满和线路空闲时报告写位置，两次报告之间收到的数据不能超过一整圈：
+// 2Mbaud约200字节/ms，256字节时半满事件间隔约640us
+#ifndef UART_RX_DMA_SIZE
+#define UART_RX_DMA_SIZE 256
+#endif
+
+// 发送接续模式：发送完成中断中直接启动下一段DMA，只在缓冲区发送完或写入者等待空间时通知任务；
+// DMA发送在传输完成（最后一个字节进入数据寄存器）时就接上下一段，连续发送时线路不空闲。
+// 为0时每段发送完成后交给worker启动下一段
+#ifndef UART_TX_ISR_CHAIN
+#define UART_TX_ISR_CHAIN 1
+#endif
+
+// uart_writev中不小于此长度的段直接由DMA从调用者缓冲区发送（不复制到发送缓冲区）
+#ifndef UART_TX_ZEROCOPY_MIN
+#define UART_TX_ZEROCOPY_MIN 256
+#endif
+
+// 每端口收发统计（计数、缓冲区高水位、写入等待时间、发送延迟直方图）
+// 发送延迟用DWT周期计数器测量
+#ifndef UART_STATS_ENABLE
+#define UART_STATS_ENABLE 1
+#endif
+
+// 注册shell命令"uart"打印统计（需要lwshell）
+#ifndef UART_SHELL_CMD
+#define UART_SHELL_CMD 1
 #endif
 
 /*
 同步发送：等待发送结束
-异步发送：写入streambuf（使用freertos的streambuf），由worker线程进行实际发送
+异步发送：写入发送环形缓冲区后立即返回，由中断或worker线程启动DMA/中断发送
 
 同步接收：等待指定数量的数据接收完成后返回
 异步接收：接收到指定数量的数据后执行对于的回调函数--hal库的回调函数在中断中执行，这里的中断函数在worker线程中执行，减少中断延迟
 
+循环接收：
+    如果存在huart->hdmarx,则DMA以循环模式持续写入环形缓冲区，半满/满/空闲事件中把新数据复制到接收环形缓冲区(uart_ring.h)
+    否则使用中断逐字节接收
+
 循环发送：
-    如果存者huart->hdmatx,则使用dma发送
+    数据写入bip环形缓冲区(uart_ring.h)，每次取出一段连续数据原地发送，不再复制到临时缓冲区
+    如果存在huart->hdmatx,则使用dma发送，DMA完成中断中直接启动下一段（UART_TX_ISR_CHAIN）
     否则使用中断发送
 worker线程：
-    阻塞等待一个队列
+    中断只提交工作对象（已排队时不重复入队），worker线程用任务通知等待，
+    执行启动发送、接收事件分发等不适合在中断中做的工作
 
 */
 
+// 端口收发方式
 typedef enum
 {
-    UART_NUM_0,
-    UART_NUM_1,
-    UART_NUM_2,
-    // 根据设备型号宏添加额外的串口设备
+    UART_XFER_DMA = 0, // 有DMA通道（CubeMX中关联了hdmatx/hdmarx）的方向使用DMA，否则使用中断
+    UART_XFER_IT,      // 中断收发，不使用DMA通道
+    UART_XFER_POLL,    // 轮询：worker中分块阻塞发送，worker定时读取接收（只适合低波特率）
+} uart_xfer_mode_t;
+
+// 轮询模式：每次发送的最大字节数（发完一块后重新排队，不长时间占用worker）
+#ifndef UART_POLL_TX_CHUNK
+#define UART_POLL_TX_CHUNK 64
+#endif
+
+// 轮询模式：接收轮询周期（ms）。单字节接收寄存器在周期内只能收一个字节，115200下1ms约11字节会溢出
+#ifndef UART_POLL_RX_PERIOD_MS
+#define UART_POLL_RX_PERIOD_MS 1
+#endif
+
+/*
+端口表：UART_PORT(端口号, HAL句柄, 收发方式, 发送缓冲区大小, 接收缓冲区大小)
+板级通过编译选项UART_PORT_CFG_FILE指定一个定义UART_PORT_TABLE的头文件，例如H7的8个串口：
+
+    // uart_board.h，CMake中 target_compile_definitions(... UART_PORT_CFG_FILE="uart_board.h")
+    #define UART_PORT_TABLE(UART_PORT)                              \
+        UART_PORT(UART_NUM_0, huart1, UART_XFER_DMA, 2048, 2048)    \
+        UART_PORT(UART_NUM_1, huart2, UART_XFER_IT, 256, 256)       \
+        ...                                                         \
+        UART_PORT(UART_NUM_7, huart8, UART_XFER_POLL, 128, 64)
+
+端口枚举、HAL句柄声明、静态存储和每个端口的HAL回调都由端口表在编译时生成。
+*/
+#ifdef UART_PORT_CFG_FILE
+#include UART_PORT_CFG_FILE
+#endif
+
+#ifndef UART_PORT_TABLE
+#define UART_PORT_TABLE(UART_PORT)                           \
+    UART_PORT(UART_NUM_0, huart1, UART_XFER_DMA, 1024, 1024) \
+    UART_PORT(UART_NUM_1, huart2, UART_XFER_DMA, 1024, 1024) \
+    UART_PORT(UART_NUM_2, huart3, UART_XFER_DMA, 1024, 1024)
+#endif
+
+#define UART_PORT_ENUM(port, handle, mode, tx_size, rx_size) port,
+typedef enum
+{
+    UART_PORT_TABLE(UART_PORT_ENUM)
     UART_NUM_MAX,
 } uart_port_t;
+#undef UART_PORT_ENUM
 
+/**
+ * @brief 初始化端口
+ * @param port 端口号
+ * @param size 收发缓冲区大小，0表示使用端口表中的大小（静态分配模式下不能超过端口表中的大小）
+ */
 esp_err_t uart_async_init(uart_port_t port, uint32_t size);
 
+// 分段发送的一段数据
+typedef struct
+{
+    const void *base; // 数据
+    size_t len;       // 长度
+} uart_iovec_t;
+
+// 异步发送请求状态
+typedef enum
+{
+    UART_TX_REQ_IDLE = 0, // 未提交
+    UART_TX_REQ_PENDING,  // 排队或正在发送
+    UART_TX_REQ_DONE      // 已完成（result为结果）
+} uart_tx_req_state_t;
+
+struct uart_tx_req;
+
+// 异步发送完成回调（在worker线程中执行）
+typedef void (*uart_tx_done_cb_t)(struct uart_tx_req *req, esp_err_t result);
+
+// 异步发送请求，由调用者分配，发送完成前请求和数据都必须保持有效
+typedef struct uart_tx_req
+{
+    worker_work_t work;         // 内部使用：在worker线程中执行完成回调
+    struct uart_tx_req *next;   // 内部使用：发送队列
+    const uint8_t *data;        // 数据（由DMA直接发送，不复制）
+    uint32_t len;               // 长度
+    uint32_t sent;              // 内部使用：已发送的字节数
+    uint32_t mark;              // 内部使用：排在请求之前的缓冲区数据的结束位置
+    uart_tx_done_cb_t cb;       // 完成回调（可为NULL）
+    void *arg;                  // 回调参数
+    volatile esp_err_t result;  // 发送结果
+    volatile uint8_t state;     // uart_tx_req_state_t
+} uart_tx_req_t;
+
 /**
  * @brief Send data to the UART port from a given buffer and length,
  *
@@ -54,6 +179,55 @@ esp_err_t uart_async_init(uart_port_t port, uint32_t size);
  */
 int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size);
 
+/**
+ * @brief 分段发送（头部、负载、校验等），各段在线路上连续，不会被其他写入者插入
+ *
+ * 小于UART_TX_ZEROCOPY_MIN的段复制到发送缓冲区；更长的段由DMA直接从调用者缓冲区发送，
+ * 函数等这些段发送完后才返回。
+ *
+ * @param uart_num UART端口号
+ * @param iov 分段数组
+ * @param iovcnt 段数
+ *
+ * @return
+ *     - (-1) 参数错误
+ *     - OTHERS (>=0) 已写入发送缓冲区或已发送的字节数（超时时可能小于总长度）
+ */
+int uart_writev(uart_port_t uart_num, const uart_iovec_t *iov, int iovcnt);
+
+/**
+ * @brief 初始化异步发送请求
+ * @param req 请求
+ * @param data 数据（完成前保持有效）
+ * @param len 长度
+ * @param cb 完成回调（在worker线程中执行，可为NULL）
+ * @param arg 回调参数
+ */
+void uart_tx_req_init(uart_tx_req_t *req, const void *data, uint32_t len, uart_tx_done_cb_t cb, void *arg);
+
+/**
+ * @brief 异步发送，立即返回
+ *
+ * 数据不复制，排在此前写入的数据之后由DMA直接发送，完成后执行回调。
+ * 可以用uart_tx_req_wait等待完成。
+ *
+ * @return
+ *     - ESP_OK 已排队
+ *     - ESP_ERR_INVALID_ARG 参数错误
+ *     - ESP_ERR_INVALID_STATE 端口未初始化或请求正在发送
+ */
+esp_err_t uart_write_async(uart_port_t uart_num, uart_tx_req_t *req);
+
+/**
+ * @brief 等待异步发送完成
+ * @return
+ *     - ESP_OK 发送完成
+ *     - ESP_FAIL 发送失败或被uart_clear取消
+ *     - ESP_ERR_TIMEOUT 超时
+ *     - ESP_ERR_INVALID_STATE 请求未提交
+ */
+esp_err_t uart_tx_req_wait(uart_port_t uart_num, uart_tx_req_t *req, TickType_t ticks_to_wait);
+
 /**
  * @brief UART read bytes from UART buffer
  *
@@ -68,9 +242,197 @@ int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size);
  */
 int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait);
 
-// 等待streambuf写入完毕
+/**
+ * @brief 接收到分隔符为止的数据（含分隔符）
+ *
+ * 在接收缓冲区中原地查找分隔符，中断只在收到分隔符或缓冲满max字节时唤醒读取者，
+ * 每次调用通常只等待一次，不需要逐字节读取。
+ *
+ * @param uart_num 端口号
+ * @param delim 分隔符
+ * @param buf 接收缓冲区
+ * @param max 最多接收的字节数，max字节内没有分隔符时返回max字节，剩余部分下次读取
+ * @param ticks_to_wait 超时时间
+ * @return 接收的字节数（最后一个字节是delim，或等于max），超时返回0（数据留在缓冲区中），参数错误返回-1
+ */
+int uart_read_until(uart_port_t uart_num, uint8_t delim, void *buf, uint32_t max, TickType_t ticks_to_wait);
+
+/**
+ * @brief 接收一行，去掉行尾的"\n"或"\r\n"，以'\0'结尾
+ * @param buf 接收缓冲区
+ * @param max 缓冲区大小（含'\0'），超过max-1字节的行分多次返回
+ * @param ticks_to_wait 超时时间
+ * @return 行长度（不含行尾，可以为0），超时或错误返回-1
+ */
+int uart_readline(uart_port_t uart_num, char *buf, uint32_t max, TickType_t ticks_to_wait);
+
+// 接收事件类型（与ESP-IDF的uart_event_type_t对应）
+typedef enum
+{
+    UART_EVENT_DATA,        // 缓冲数据达到min_bytes，或收到数据后线路空闲超过idle_timeout_us
+    UART_EVENT_BREAK,       // 收到break（帧错误且数据为0）
+    UART_EVENT_BUFFER_FULL, // 接收缓冲区满，新数据被丢弃
+    UART_EVENT_FIFO_OVF,    // 硬件接收溢出（读取不及时）
+    UART_EVENT_FRAME_ERR,   // 帧错误
+    UART_EVENT_PARITY_ERR,  // 校验错误
+    UART_EVENT_PATTERN_DET, // 收到模式检测字符
+    UART_EVENT_MAX,
+} uart_event_type_t;
+
+// 接收事件
+typedef struct
+{
+    uart_event_type_t type; // 事件类型
+    size_t size;            // UART_EVENT_DATA：缓冲的字节数；UART_EVENT_PATTERN_DET：读到最后一个模式字符
+                            // 需要读取的字节数；其他：缓冲的字节数
+    bool timeout_flag;      // UART_EVENT_DATA因线路空闲上报（缓冲数据未达到min_bytes）
+} uart_event_t;
+
+/**
+ * @brief 接收事件回调（在worker线程中执行，同一端口的回调不会并发）
+ */
+typedef void (*uart_event_cb_t)(uart_port_t port, const uart_event_t *event);
+
+/**
+ * @brief 设置接收事件回调
+ *
+ * 中断中只检查条件并记录事件，同一批数据的事件合并后在worker线程中回调一次，
+ * 使用者不需要轮询uart_get_buffered_data_len，也不需要为等待数据阻塞一个任务。
+ *
+ * @param uart_num 端口号
+ * @param min_bytes 缓冲数据达到该字节数时上报UART_EVENT_DATA，0表示只按空闲上报
+ * @param idle_timeout_us 收到数据后线路空闲该时间仍未达到min_bytes时上报UART_EVENT_DATA，0表示不按空闲上报。
+ *                        不超过一个字符时间（8N1时为10位）时由DMA接收的硬件空闲事件在中断中直接上报，
+ *                        分辨率为一个字符时间，可用于按帧间隔分帧；否则按系统tick计时（向上取整），
+ *                        另有worker调度延迟，中断接收和轮询模式的端口总是按tick计时。
+ *                        修改波特率后按新的字符时间重新选择
+ * @param cb 回调，NULL表示关闭事件
+ * @return ESP_OK成功，ESP_ERR_INVALID_ARG参数错误（min_bytes超过接收缓冲区大小）
+ */
+esp_err_t uart_set_rx_event(uart_port_t uart_num, uint32_t min_bytes, uint32_t idle_timeout_us, uart_event_cb_t cb);
+
+// 流控方式
+typedef enum
+{
+    UART_HW_FLOWCTRL_DISABLE = 0x0, // 不使用流控
+    UART_HW_FLOWCTRL_RTS = 0x1,     // 按接收缓冲区水位控制RTS
+    UART_HW_FLOWCTRL_CTS = 0x2,     // 硬件CTS：对方撤销CTS时发送暂停（DMA随之暂停）
+    UART_HW_FLOWCTRL_CTS_RTS = 0x3, // 两者都使用
+} uart_hw_flowcontrol_t;
+
+/**
+ * @brief RTS输出（中断中调用，只能写GPIO等不阻塞的操作）
+ * @param ready true：允许对方发送（RTS有效，通常为低电平） false：要求对方暂停
+ */
+typedef void (*uart_rts_set_t)(uart_port_t port, bool ready);
+
+// 流控配置
+typedef struct
+{
+    uart_hw_flowcontrol_t flow_ctrl; // 流控方式
+    uint32_t rx_high;                // 接收缓冲数据达到该值时撤销RTS，0表示接收缓冲区大小的3/4
+    uint32_t rx_low;                 // 读取后降到该值以下时恢复RTS，0表示接收缓冲区大小的1/4
+    uart_rts_set_t set_rts;          // RTS引脚控制（UART_HW_FLOWCTRL_RTS时必须提供）
+} uart_flow_ctrl_t;
+
+/**
+ * @brief 设置流控
+ *
+ * RTS由驱动按接收环形缓冲区的水位控制：循环DMA接收时USART数据寄存器总是被取空，
+ * 硬件RTS不会撤销，因此RTS引脚配置为GPIO输出，由set_rts控制。
+ * 高水位之上要留出撤销RTS后对方还会发出的数据：接收事件间隔（最多UART_RX_DMA_SIZE/2字节）
+ * 加上对方发送FIFO的深度。
+ *
+ * CTS使用硬件CTS（CTS引脚需在CubeMX中配置为复用输入），设置时会短暂关闭USART，
+ * 应在初始化后、开始通信前调用。
+ *
+ * @param uart_num 端口号（已初始化）
+ * @param cfg 流控配置
+ * @return ESP_OK成功，ESP_ERR_INVALID_ARG参数错误，ESP_ERR_INVALID_STATE端口未初始化
+ */
+esp_err_t uart_set_flow_ctrl(uart_port_t uart_num, const uart_flow_ctrl_t *cfg);
+
+/**
+ * @brief RS-485收发器DE控制（中断中调用，只能写GPIO等不阻塞的操作）
+ * @param tx true：使能驱动器（发送） false：释放总线（接收）
+ */
+typedef void (*uart_de_set_t)(uart_port_t port, bool tx);
+
+// RS-485半双工配置
+typedef struct
+{
+    bool enable;          // 启用RS-485半双工
+    bool echo_suppress;   // 丢弃发送期间收到的数据（收发器RE常开或单线半双工时会收到自己发出的数据）
+    uart_de_set_t set_de; // DE控制；NULL时使用USART硬件DE（带USART_CR3_DEM的系列，如H7），
+                          // 没有硬件DE时表示不需要DE（单线半双工HAL_HalfDuplex_Init）
+} uart_rs485_t;
+
+/**
+ * @brief 设置RS-485半双工模式
+ *
+ * 发送开始前使能DE，最后一个字节的停止位发完（TC中断）且没有后续数据时释放DE，
+ * 连续写入的数据在同一次DE有效期间连续发出。需要DMA或中断方式，应在发送空闲时调用。
+ *
+ * @param uart_num 端口号（已初始化）
+ * @param cfg RS-485配置
+ * @return ESP_OK成功，ESP_ERR_INVALID_STATE端口未初始化或正在发送，ESP_ERR_NOT_SUPPORTED轮询方式的端口
+ */
+esp_err_t uart_set_rs485(uart_port_t uart_num, const uart_rs485_t *cfg);
+
+/**
+ * @brief 设置波特率
+ *
+ * 等待发送缓冲区发完，按新的波特率和当前的PCLK重新配置USART，再重新启动接收；
+ * 之前已收到的数据保留在接收缓冲区中。切换系统时钟后以原波特率调用可重新计算BRR。
+ *
+ * @param uart_num 端口号（已初始化）
+ * @param baud_rate 波特率（最高为USART时钟的1/16）
+ * @return ESP_OK成功，ESP_ERR_TIMEOUT 1秒内没有发完，ESP_FAIL HAL配置失败（恢复原波特率）
+ */
+esp_err_t uart_set_baudrate(uart_port_t uart_num, uint32_t baud_rate);
+
+/**
+ * @brief 获取当前波特率
+ */
+esp_err_t uart_get_baudrate(uart_port_t uart_num, uint32_t *baud_rate);
+
+// 自动波特率检测方式（对方发送的同步字符）
+typedef enum
+{
+    UART_ABR_START_BIT = 0, // 测量起始位：bit0为1的任意字符
+    UART_ABR_FALLING_EDGE,  // 测量两个下降沿：以二进制10开头的字符（bit0=1, bit1=0）
+    UART_ABR_0X7F,          // 0x7F
+    UART_ABR_0X55,          // 0x55
+} uart_abr_mode_t;
+
+/**
+ * @brief 自动波特率检测（USART ABR功能，H7/F7/L4/G4等系列）
+ *
+ * 等待对方发送一个同步字符，检测到的波特率写入BRR并成为当前波特率；同步字符可能进入接收缓冲区。
+ *
+ * @param uart_num 端口号（已初始化）
+ * @param mode 同步字符
+ * @param ticks_to_wait 等待同步字符的时间
+ * @param baud_rate 输出：检测到的波特率
+ * @return ESP_OK成功，ESP_ERR_TIMEOUT超时，ESP_FAIL检测出错（保持原波特率），
+ *         ESP_ERR_NOT_SUPPORTED USART没有ABR功能（F1/F4）
+ */
+esp_err_t uart_detect_baudrate(uart_port_t uart_num, uart_abr_mode_t mode, TickType_t ticks_to_wait,
+                               uint32_t *baud_rate);
+
+/**
+ * @brief 启用模式检测：收到pattern_chr时上报UART_EVENT_PATTERN_DET
+ */
+esp_err_t uart_enable_pattern_det(uart_port_t uart_num, char pattern_chr);
+
+/**
+ * @brief 关闭模式检测
+ */
+esp_err_t uart_disable_pattern_det(uart_port_t uart_num);
+
+// 等待发送环形缓冲区中的数据发送完毕
 esp_err_t uart_flush(uart_port_t uart_num);
-// 清空streambuf
+// 清空收发环形缓冲区（正在DMA发送的一段除外），取消排队中的异步发送请求
 esp_err_t uart_clear(uart_port_t uart_num);
 
 /**
@@ -97,4 +459,55 @@ esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size);
  */
 esp_err_t uart_get_tx_buffer_free_size(uart_port_t uart_num, size_t *size);
 
+// 发送延迟直方图桶数：第0桶 < 64us，第i桶 < 64us × 4^i，最后一桶不设上限
+#define UART_STATS_LATENCY_BUCKETS 8
+
+// 端口统计
+typedef struct
+{
+    uint32_t tx_bytes;          // 已发送字节数
+    uint32_t rx_bytes;          // 写入接收缓冲区的字节数
+    uint32_t tx_xfers;          // 发送DMA（无DMA时为中断）传输次数
+    uint32_t rx_events;         // 接收事件次数（DMA半满/满/空闲，中断模式下为字节数）
+    uint32_t overrun_errors;    // 溢出错误
+    uint32_t framing_errors;    // 帧错误
+    uint32_t noise_errors;      // 噪声错误
+    uint32_t parity_errors;     // 校验错误
+    uint32_t dma_errors;        // DMA传输错误
+    uint32_t rx_dropped;        // 接收缓冲区满丢弃的字节数
+    uint32_t rts_stalls;        // 接收缓冲区达到高水位撤销RTS的次数
+    uint32_t rx_echo;           // RS-485发送期间丢弃的回波字节数
+    uint32_t tx_short_writes;   // 超时未全部写入的uart_write_bytes/uart_writev次数
+    uint32_t tx_short_bytes;    // 因此未写入的字节数
+    uint32_t tx_high_water;     // 发送缓冲区占用的历史最大值
+    uint32_t rx_high_water;     // 接收缓冲区占用的历史最大值
+    uint32_t tx_wait_count;     // 写入者等待发送空间的次数
+    uint32_t tx_wait_ms;        // 累计等待时间
+    uint32_t tx_wait_max_ms;    // 单次最长等待时间
+    uint32_t tx_latency_max_us; // 最大发送延迟
+    // 发送延迟直方图：uart_write_bytes写入到最后一个字节发送完成（抽样，同时最多跟踪4次写入）
+    uint32_t tx_latency[UART_STATS_LATENCY_BUCKETS];
+} uart_stats_t;
+
+/**
+ * @brief 获取端口统计（UART_STATS_ENABLE为0时全部为0）
+ * @param uart_num UART端口号
+ * @param stats 输出：统计快照
+ * @return
+ *     - ESP_OK 成功
+ *     - ESP_ERR_INVALID_ARG 参数错误
+ *     - ESP_ERR_INVALID_STATE 端口未初始化
+ */
+esp_err_t uart_get_stats(uart_port_t uart_num, uart_stats_t *stats);
+
+/**
+ * @brief 清零端口统计
+ */
+esp_err_t uart_reset_stats(uart_port_t uart_num);
+
+/**
+ * @brief 打印端口统计（调试用）
+ */
+void uart_print_stats(uart_port_t uart_num);
+
 void uart3_test();
\ No newline at end of file
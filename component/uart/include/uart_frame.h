@@ -0,0 +1,159 @@
+#pragma once
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =============================================================================
+// 帧层：COBS编码 + CRC16/CRC32校验，0x00为帧分隔符
+// =============================================================================
+//
+// 发送：负载后附加CRC（小端），整体COBS编码，末尾加0x00。编码后的数据中不含0x00，
+// 接收方从任意位置开始都能在下一个0x00处重新同步。
+//
+// 接收：解码器从帧缓冲池中取一个缓冲区，串口数据直接读到缓冲区尾部；提交后用memchr查找分隔符，
+// 完整的帧在缓冲区中原地解码、校验，然后交给回调。逐块处理，没有逐字节的函数调用。
+// 本模块不依赖HAL和FreeRTOS，可以在主机上编译测试（见test/frame_bench.c和test/frame_fuzz.c）。
+//
+// 示例：
+//   static uart_frame_t frames[4];
+//   static uart_frame_decoder_t dec;
+//   uart_frame_decoder_init(&dec, frames, 4, UART_FRAME_CRC16, on_frame, NULL);
+//
+//   // 接收任务
+//   uint8_t *buf;
+//   size_t space = uart_frame_rx_buffer(&dec, &buf);
+//   int n = uart_read_bytes(port, buf, space, portMAX_DELAY);
+//   if (n > 0) uart_frame_rx_commit(&dec, n);      // 完整的帧在这里交给on_frame
+//
+//   // on_frame中使用frame->data/frame->len，用完（可在其他任务中）调用uart_frame_release
+//
+//   // 发送
+//   uint8_t out[UART_FRAME_ENCODED_MAX(sizeof(msg) + 2)];
+//   size_t len = uart_frame_encode(UART_FRAME_CRC16, &msg, sizeof(msg), out, sizeof(out));
+//   uart_write_bytes(port, out, len);
+
+// 最大负载长度（不含CRC）
+#ifndef UART_FRAME_MAX_PAYLOAD
+#define UART_FRAME_MAX_PAYLOAD 256
+#endif
+
+// n字节数据COBS编码后的最大长度（含结尾的分隔符）
+#define UART_FRAME_ENCODED_MAX(n) ((n) + (n) / 254 + 2)
+
+// 帧缓冲区大小：最大负载加CRC32编码后的长度，编码数据填满缓冲区仍没有分隔符即判定帧过长
+#define UART_FRAME_BUF_SIZE UART_FRAME_ENCODED_MAX(UART_FRAME_MAX_PAYLOAD + 4)
+
+    // 校验方式
+    typedef enum
+    {
+        UART_FRAME_CRC_NONE = 0, // 不校验
+        UART_FRAME_CRC16,        // CRC-16/CCITT-FALSE（多项式0x1021，初值0xFFFF）
+        UART_FRAME_CRC32,        // CRC-32（IEEE 802.3）
+    } uart_frame_crc_t;
+
+    struct uart_frame_decoder;
+
+    // 帧缓冲区，由调用者静态分配后交给解码器
+    typedef struct uart_frame
+    {
+        struct uart_frame *next;                // 内部使用：空闲链表
+        uint32_t len;                           // 负载长度（不含CRC）
+        uint8_t data[UART_FRAME_BUF_SIZE];      // 负载（接收时先存放编码数据，原地解码）
+    } uart_frame_t;
+
+    /**
+     * @brief 收到完整帧的回调（在调用uart_frame_rx_commit的任务中执行）
+     *
+     * 帧交给回调后归调用者所有，用完后调用uart_frame_release归还缓冲池。
+     */
+    typedef void (*uart_frame_cb_t)(struct uart_frame_decoder *dec, uart_frame_t *frame, void *arg);
+
+    // 解码统计
+    typedef struct
+    {
+        uint32_t frames;        // 交给回调的帧数
+        uint32_t crc_errors;    // 校验错误
+        uint32_t decode_errors; // COBS格式错误或长度不足CRC
+        uint32_t oversize;      // 超过帧缓冲区的帧
+        uint32_t no_buffer;     // 缓冲池用完丢弃的帧
+    } uart_frame_stats_t;
+
+    // 解码器
+    typedef struct uart_frame_decoder
+    {
+        uart_frame_t *free;      // 内部使用：空闲帧（uart_frame_release可在其他任务中调用）
+        uart_frame_t *cur;       // 内部使用：正在接收的帧，NULL表示缓冲池用完
+        uint32_t fill;           // 内部使用：cur中已收到的编码字节数
+        bool discard;            // 内部使用：丢弃到下一个分隔符（帧过长或没有缓冲区）
+        uint8_t crc;             // uart_frame_crc_t
+        uint8_t scratch[32];     // 内部使用：没有空闲帧时接收并丢弃数据
+        uart_frame_cb_t cb;      // 帧回调
+        void *arg;               // 回调参数
+        uart_frame_stats_t stats; // 统计
+    } uart_frame_decoder_t;
+
+    /**
+     * @brief 初始化解码器
+     * @param dec 解码器
+     * @param frames 帧缓冲区数组（在整个使用期间有效）
+     * @param count 帧缓冲区数量（至少1个）
+     * @param crc 校验方式（需与发送方一致）
+     * @param cb 帧回调
+     * @param arg 回调参数
+     */
+    void uart_frame_decoder_init(uart_frame_decoder_t *dec, uart_frame_t *frames, uint32_t count,
+                                 uart_frame_crc_t crc, uart_frame_cb_t cb, void *arg);
+
+    /**
+     * @brief 获取下一次接收数据的写入位置
+     * @param buf 输出：写入位置
+     * @return 可写入的字节数（大于0）
+     */
+    size_t uart_frame_rx_buffer(uart_frame_decoder_t *dec, uint8_t **buf);
+
+    /**
+     * @brief 提交写入uart_frame_rx_buffer位置的len字节，完整的帧交给回调
+     */
+    void uart_frame_rx_commit(uart_frame_decoder_t *dec, size_t len);
+
+    /**
+     * @brief 输入任意位置的数据（复制到帧缓冲区后处理）
+     */
+    void uart_frame_feed(uart_frame_decoder_t *dec, const void *data, size_t len);
+
+    /**
+     * @brief 归还帧缓冲区（可在任意任务或中断中调用）
+     */
+    void uart_frame_release(uart_frame_decoder_t *dec, uart_frame_t *frame);
+
+    /**
+     * @brief 编码一帧：负载 + CRC（小端），COBS编码，结尾0x00
+     * @param crc 校验方式
+     * @param payload 负载
+     * @param len 负载长度（不超过UART_FRAME_MAX_PAYLOAD时接收方能完整收下）
+     * @param dst 输出缓冲区（UART_FRAME_ENCODED_MAX(len + CRC长度)字节足够）
+     * @param dst_size 输出缓冲区大小
+     * @return 编码后的长度（含分隔符），输出缓冲区不足时返回0
+     */
+    size_t uart_frame_encode(uart_frame_crc_t crc, const void *payload, size_t len, uint8_t *dst, size_t dst_size);
+
+    /**
+     * @brief CRC-16/CCITT-FALSE
+     * @param crc 初值（0xFFFF），分段计算时传入上一段的结果
+     */
+    uint16_t uart_frame_crc16(uint16_t crc, const void *data, size_t len);
+
+    /**
+     * @brief CRC-32（IEEE 802.3）
+     * @param crc 初值（0），分段计算时传入上一段的结果
+     */
+    uint32_t uart_frame_crc32(uint32_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
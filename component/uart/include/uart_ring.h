@@ -0,0 +1,118 @@
+#pragma once
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =============================================================================
+// 单生产者/单消费者bip环形缓冲区（收发路径使用）
+// =============================================================================
+//
+// 与普通环形缓冲区不同，写入方预留的是一段连续空间：末尾放不下时整段从开头写，
+// 末尾剩余部分用last标记跳过。读取方每次得到一段连续的可读数据，DMA可以直接
+// 从缓冲区中发送，不需要再复制到临时缓冲区。
+//
+// 写入方和读取方各自只修改自己的索引，不需要临界区。发送时写入方是持有发送互斥锁的任务，
+// 读取方是发送启动/完成中断；接收时反过来，写入方是接收中断，读取方是持有接收互斥锁的任务。
+//
+// 示例：
+//   uint8_t *dst = uart_ring_write_reserve(&ring, len);      // 连续len字节
+//   memcpy(dst, data, len);
+//   uart_ring_write_commit(&ring, len);
+//
+//   uint32_t n;
+//   uint8_t *src = uart_ring_read_acquire(&ring, &n);        // 连续n字节
+//   HAL_UART_Transmit_DMA(huart, src, n);
+//   ...发送完成中断中：
+//   uart_ring_read_release(&ring, n);
+
+typedef struct
+{
+    uint8_t *buf;       // 存储区
+    uint32_t size;      // 存储区大小
+    uint32_t write;     // 写位置（写入方修改）
+    uint32_t read;      // 读位置（读取方修改）
+    uint32_t last;      // 有效数据末尾（回绕时标记被跳过的尾部，写入方修改）
+    uint32_t grant;     // 当前预留区起始位置（写入方内部使用）
+    uint32_t grant_len; // 当前预留区长度，0表示没有预留（写入方内部使用）
+} uart_ring_t;
+
+/**
+ * @brief 初始化环形缓冲区
+ * @param ring 缓冲区
+ * @param buf 存储区
+ * @param size 存储区大小
+ */
+void uart_ring_init(uart_ring_t *ring, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief 清空缓冲区（调用者保证此时没有读写在进行）
+ */
+void uart_ring_reset(uart_ring_t *ring);
+
+// 一定能预留到的最大连续长度：缓冲区变空时读写位置可能停在中间，连续空间只剩一半
+#define UART_RING_RESERVE_MAX(ring) (((ring)->size - 1) / 2)
+
+/**
+ * @brief 预留len字节连续写入空间
+ * @param len 长度（不能超过UART_RING_RESERVE_MAX，否则可能永远等不到空间）
+ * @return 写入位置，空间不足或len超过UART_RING_RESERVE_MAX时返回NULL
+ */
+uint8_t *uart_ring_write_reserve(uart_ring_t *ring, uint32_t len);
+
+/**
+ * @brief 预留尽量多（最多max字节）的连续写入空间
+ * @param len 输出：实际预留的字节数
+ * @return 写入位置，缓冲区满时返回NULL
+ */
+uint8_t *uart_ring_write_reserve_max(uart_ring_t *ring, uint32_t max, uint32_t *len);
+
+/**
+ * @brief 提交预留区中已写入的前used字节（其余部分归还）
+ */
+void uart_ring_write_commit(uart_ring_t *ring, uint32_t used);
+
+/**
+ * @brief 获取一段连续的可读数据
+ * @param len 输出：可读字节数
+ * @return 数据位置，缓冲区空时返回NULL
+ */
+uint8_t *uart_ring_read_acquire(uart_ring_t *ring, uint32_t *len);
+
+/**
+ * @brief 查看距读位置offset字节处开始的一段连续可读数据，不释放（读取方调用）
+ * @param len 输出：可读字节数
+ * @return 数据位置，offset之后没有数据时返回NULL
+ */
+uint8_t *uart_ring_read_peek(uart_ring_t *ring, uint32_t offset, uint32_t *len);
+
+/**
+ * @brief 释放已读取（已发送）的used字节
+ */
+void uart_ring_read_release(uart_ring_t *ring, uint32_t used);
+
+/**
+ * @brief 丢弃全部未读数据（读取方调用）
+ */
+void uart_ring_read_discard(uart_ring_t *ring);
+
+/**
+ * @brief 已写入未释放的字节数
+ */
+uint32_t uart_ring_used(const uart_ring_t *ring);
+
+/**
+ * @brief 缓冲区是否为空
+ */
+static inline bool uart_ring_empty(const uart_ring_t *ring)
+{
+    return __atomic_load_n(&ring->read, __ATOMIC_ACQUIRE) == __atomic_load_n(&ring->write, __ATOMIC_ACQUIRE);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,124 @@
+// 帧层吞吐量测试（主机编译，不依赖HAL和FreeRTOS）
+//
+//   gcc -O2 -DUART_FRAME_TEST_STANDALONE -I../include frame_bench.c ../uart_frame.c -o frame_bench
+//   ./frame_bench
+//
+// 解码按串口接收任务的方式进行：每次读chunk字节到uart_frame_rx_buffer返回的位置后提交。
+// 只在主机上独立编译（定义UART_FRAME_TEST_STANDALONE），随组件编译进固件时为空。
+
+#ifdef UART_FRAME_TEST_STANDALONE
+
+#include "uart_frame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_BYTES (64u * 1024 * 1024) // 每项测试处理的负载总量
+
+static uint8_t stream[2 * 1024 * 1024];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void on_frame(uart_frame_decoder_t *dec, uart_frame_t *frame, void *arg)
+{
+    *(uint32_t *)arg += frame->len;
+    uart_frame_release(dec, frame);
+}
+
+static void bench(uart_frame_crc_t crc, size_t payload_len, size_t chunk)
+{
+    static const char *crc_name[] = {"none ", "crc16", "crc32"};
+    uint8_t payload[UART_FRAME_MAX_PAYLOAD];
+    for (size_t i = 0; i < payload_len; i++)
+    {
+        payload[i] = (uint8_t)(rand() % 8 == 0 ? 0 : rand());
+    }
+
+    // 编码：填满stream后重复
+    size_t frames = BENCH_BYTES / payload_len;
+    size_t stream_len = 0;
+    size_t stream_frames = 0;
+    double t0 = now();
+    for (size_t i = 0; i < frames; i++)
+    {
+        size_t n = uart_frame_encode(crc, payload, payload_len, stream + stream_len, sizeof(stream) - stream_len);
+        if (n == 0)
+        {
+            stream_len = 0;
+            n = uart_frame_encode(crc, payload, payload_len, stream, sizeof(stream));
+        }
+        else if (stream_frames == i)
+        {
+            stream_frames++;
+        }
+        stream_len += n;
+    }
+    double t_enc = now() - t0;
+
+    // 解码：反复输入stream中完整的帧
+    stream_len = 0;
+    for (size_t i = 0; i < stream_frames; i++)
+    {
+        stream_len += uart_frame_encode(crc, payload, payload_len, stream + stream_len, sizeof(stream) - stream_len);
+    }
+    static uart_frame_t pool[4];
+    uart_frame_decoder_t dec;
+    uint32_t received = 0;
+    uart_frame_decoder_init(&dec, pool, 4, crc, on_frame, &received);
+    size_t rounds = frames / stream_frames;
+    t0 = now();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        const uint8_t *p = stream;
+        size_t left = stream_len;
+        while (left > 0)
+        {
+            uint8_t *buf;
+            size_t n = uart_frame_rx_buffer(&dec, &buf);
+            n = n < chunk ? n : chunk;
+            n = n < left ? n : left;
+            memcpy(buf, p, n); // 相当于uart_read_bytes从接收环形缓冲区复制
+            uart_frame_rx_commit(&dec, n);
+            p += n;
+            left -= n;
+        }
+    }
+    double t_dec = now() - t0;
+
+    double mb = (double)frames * payload_len / 1e6;
+    double mb_dec = (double)rounds * stream_frames * payload_len / 1e6;
+    printf("%s payload %4zu chunk %4zu: encode %7.1f MB/s  decode %7.1f MB/s  (%u errors)\n", crc_name[crc],
+           payload_len, chunk, mb / t_enc, mb_dec / t_dec,
+           (unsigned)(dec.stats.crc_errors + dec.stats.decode_errors + dec.stats.oversize + dec.stats.no_buffer));
+    if (received != (uint32_t)(rounds * stream_frames * payload_len))
+    {
+        printf("  payload bytes mismatch: %u\n", (unsigned)received);
+        exit(1);
+    }
+}
+
+int main(void)
+{
+    static const size_t sizes[] = {16, 64, 256};
+    static const size_t chunks[] = {32, 256};
+    for (int crc = UART_FRAME_CRC_NONE; crc <= UART_FRAME_CRC32; crc++)
+    {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++)
+            {
+                bench((uart_frame_crc_t)crc, sizes[s], chunks[c]);
+            }
+        }
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,238 @@
+// 帧解码器模糊测试（主机编译，不依赖HAL和FreeRTOS）
+//
+// 独立运行（随机输入 + 编解码往返）：
+//   gcc -O1 -g -fsanitize=address,undefined -DUART_FRAME_TEST_STANDALONE -I../include frame_fuzz.c ../uart_frame.c -o frame_fuzz
+//   ./frame_fuzz [次数]
+//
+// libFuzzer：
+//   clang -O1 -g -fsanitize=fuzzer,address,undefined -DUART_FRAME_LIBFUZZER -I../include frame_fuzz.c ../uart_frame.c -o frame_fuzz
+//   ./frame_fuzz
+//
+// 两个宏都没有定义时（随组件编译进固件）为空。
+
+#if defined(UART_FRAME_TEST_STANDALONE) || defined(UART_FRAME_LIBFUZZER)
+
+#include "uart_frame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FUZZ_CHECK(cond)                                                                   \
+    do                                                                                     \
+    {                                                                                      \
+        if (!(cond))                                                                       \
+        {                                                                                  \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);       \
+            abort();                                                                       \
+        }                                                                                  \
+    } while (0)
+
+#define FUZZ_POOL 3
+
+typedef struct
+{
+    const uint8_t *expect; // 期望收到的负载（NULL表示不检查内容）
+    size_t expect_len;
+    uint32_t received;
+    bool hold;                       // 回调不立即归还，模拟处理较慢的使用者
+    uart_frame_t *held[FUZZ_POOL];
+    uint32_t held_count;
+} fuzz_ctx_t;
+
+static void on_frame(uart_frame_decoder_t *dec, uart_frame_t *frame, void *arg)
+{
+    fuzz_ctx_t *ctx = arg;
+    FUZZ_CHECK(frame->len <= UART_FRAME_BUF_SIZE);
+    if (ctx->expect != NULL)
+    {
+        FUZZ_CHECK(frame->len == ctx->expect_len);
+        FUZZ_CHECK(memcmp(frame->data, ctx->expect, frame->len) == 0);
+    }
+    ctx->received++;
+    if (ctx->hold)
+    {
+        ctx->held[ctx->held_count++] = frame;
+        return;
+    }
+    uart_frame_release(dec, frame);
+}
+
+static void release_held(uart_frame_decoder_t *dec, fuzz_ctx_t *ctx)
+{
+    while (ctx->held_count > 0)
+    {
+        uart_frame_release(dec, ctx->held[--ctx->held_count]);
+    }
+}
+
+// 按chunk给出的长度分段送入解码器，模拟每次uart_read_bytes读到的长度不同
+static void feed_chunked(uart_frame_decoder_t *dec, fuzz_ctx_t *ctx, const uint8_t *data, size_t len,
+                         const uint8_t *chunk, size_t chunk_len)
+{
+    size_t i = 0;
+    while (len > 0)
+    {
+        uint8_t *buf;
+        size_t space = uart_frame_rx_buffer(dec, &buf);
+        FUZZ_CHECK(space > 0);
+        size_t n = chunk_len > 0 ? (size_t)chunk[i++ % chunk_len] + 1 : len;
+        if (n > space)
+        {
+            n = space;
+        }
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(buf, data, n);
+        uart_frame_rx_commit(dec, n);
+        data += n;
+        len -= n;
+        if (i % 4 == 0)
+        {
+            release_held(dec, ctx);
+        }
+    }
+    release_held(dec, ctx);
+}
+
+static void check_pool(uart_frame_decoder_t *dec)
+{
+    // 所有帧都已归还：空闲链表加cur正好是缓冲池的数量
+    uint32_t n = dec->cur != NULL ? 1 : 0;
+    for (uart_frame_t *f = dec->free; f != NULL; f = f->next)
+    {
+        n++;
+    }
+    FUZZ_CHECK(n == FUZZ_POOL);
+}
+
+// 任意输入不能越界，且帧缓冲区不能丢失
+static uint32_t no_buffer_total;
+
+static void fuzz_decode(const uint8_t *data, size_t size, uart_frame_crc_t crc, bool hold)
+{
+    static uart_frame_t frames[FUZZ_POOL];
+    uart_frame_decoder_t dec;
+    fuzz_ctx_t ctx = {.hold = hold};
+    uart_frame_decoder_init(&dec, frames, FUZZ_POOL, crc, on_frame, &ctx);
+    feed_chunked(&dec, &ctx, data, size, data, size < 8 ? size : 8);
+    check_pool(&dec);
+    no_buffer_total += dec.stats.no_buffer;
+    if (crc == UART_FRAME_CRC_NONE)
+    {
+        // 不校验时，不超长且格式正确的非空段都会交给回调
+        FUZZ_CHECK(ctx.received + dec.stats.decode_errors + dec.stats.oversize <= size);
+    }
+}
+
+// 负载编码后（前面可能有噪声）必须原样解出
+static void fuzz_roundtrip(const uint8_t *data, size_t size, uart_frame_crc_t crc)
+{
+    static uart_frame_t frames[FUZZ_POOL];
+    static uint8_t stream[2 * UART_FRAME_BUF_SIZE + 64];
+    uart_frame_decoder_t dec;
+
+    size_t noise = size > 0 ? data[0] % 16 : 0;
+    size_t payload_len = size > UART_FRAME_MAX_PAYLOAD ? UART_FRAME_MAX_PAYLOAD : size;
+    if (noise > size)
+    {
+        noise = size;
+    }
+
+    // 噪声以分隔符结束，之后的帧从干净的状态开始
+    memcpy(stream, data, noise);
+    stream[noise] = 0;
+    size_t enc_len = uart_frame_encode(crc, data, payload_len, stream + noise + 1, sizeof(stream) - noise - 1);
+    FUZZ_CHECK(enc_len > 0);
+    FUZZ_CHECK(enc_len <= UART_FRAME_ENCODED_MAX(payload_len + 4));
+    FUZZ_CHECK(memchr(stream + noise + 1, 0, enc_len - 1) == NULL);
+    FUZZ_CHECK(stream[noise + enc_len] == 0);
+
+    // 同一帧连发两次，第二帧从第一帧缓冲区的剩余部分中解出
+    size_t total = noise + 1 + enc_len;
+    memcpy(stream + total, stream + noise + 1, enc_len);
+    total += enc_len;
+
+    // 输出缓冲区少1字节时必须失败
+    static uint8_t small[UART_FRAME_BUF_SIZE];
+    FUZZ_CHECK(uart_frame_encode(crc, data, payload_len, small, enc_len - 1) == 0);
+
+    fuzz_ctx_t ctx = {.expect = data, .expect_len = payload_len};
+    uart_frame_decoder_init(&dec, frames, FUZZ_POOL, crc, on_frame, &ctx);
+    ctx.expect = NULL; // 噪声部分可能恰好是合法帧
+    feed_chunked(&dec, &ctx, stream, noise + 1, data, size < 8 ? size : 8);
+    uint32_t before = ctx.received;
+    ctx.expect = data;
+    feed_chunked(&dec, &ctx, stream + noise + 1, total - noise - 1, data + noise, size - noise < 8 ? size - noise : 8);
+    FUZZ_CHECK(ctx.received - before == 2);
+    check_pool(&dec);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    for (int crc = UART_FRAME_CRC_NONE; crc <= UART_FRAME_CRC32; crc++)
+    {
+        fuzz_decode(data, size, (uart_frame_crc_t)crc, false);
+        fuzz_decode(data, size, (uart_frame_crc_t)crc, true);
+        fuzz_roundtrip(data, size, (uart_frame_crc_t)crc);
+    }
+    return 0;
+}
+
+#ifndef UART_FRAME_LIBFUZZER
+
+static uint32_t rng_state = 2463534242u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void test_vectors(void)
+{
+    static const uint8_t check[] = "123456789";
+    FUZZ_CHECK(uart_frame_crc16(0xFFFF, check, 9) == 0x29B1);
+    FUZZ_CHECK(uart_frame_crc32(0, check, 9) == 0xCBF43926);
+    FUZZ_CHECK(uart_frame_crc32(uart_frame_crc32(0, check, 4), check + 4, 5) == 0xCBF43926);
+
+    static const uint8_t in[] = {0x11, 0x22, 0x00, 0x33};
+    static const uint8_t out[] = {0x03, 0x11, 0x22, 0x02, 0x33, 0x00};
+    uint8_t buf[16];
+    FUZZ_CHECK(uart_frame_encode(UART_FRAME_CRC_NONE, in, sizeof(in), buf, sizeof(buf)) == sizeof(out));
+    FUZZ_CHECK(memcmp(buf, out, sizeof(out)) == 0);
+
+    static const uint8_t zero[] = {0x00};
+    FUZZ_CHECK(uart_frame_encode(UART_FRAME_CRC_NONE, zero, 1, buf, sizeof(buf)) == 3);
+    FUZZ_CHECK(buf[0] == 0x01 && buf[1] == 0x01 && buf[2] == 0x00);
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    static uint8_t data[UART_FRAME_BUF_SIZE * 3];
+
+    test_vectors();
+    for (long i = 0; i < iterations; i++)
+    {
+        size_t size = rng() % sizeof(data);
+        uint32_t mode = rng() % 4;
+        for (size_t j = 0; j < size; j++)
+        {
+            // 一部分输入偏向0和0xFF，覆盖空块和满块
+            uint32_t r = rng();
+            data[j] = mode == 0 ? (uint8_t)r : mode == 1 ? (r % 8 == 0 ? 0 : 0xFF) : mode == 2 ? (r % 3 == 0 ? 0 : (uint8_t)r) : (uint8_t)(r | 1);
+        }
+        LLVMFuzzerTestOneInput(data, size);
+    }
+    printf("frame_fuzz: %ld iterations OK (%u frames dropped for lack of buffers)\n", iterations, (unsigned)no_buffer_total);
+    return 0;
+}
+
+#endif
+
+#endif
@@ -1,382 +1,2552 @@
 #include "hal.h"
+#include "compile.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
-#include "stream_buffer.h"
 #include "semphr.h"
 
 #include "uart.h"
+#include "uart_ring.h"
 #include "worker.h"
+#include <stdio.h>
 #include <string.h>
 
+#if UART_SHELL_CMD
+#include <stdlib.h>
+#include "lwshell/lwshell.h"
+#endif
+
+// HAL单次发送的最大长度（16位计数）
+#define UART_TX_XFER_MAX 0xFFFFu
+
+// 接收数据寄存器（出错后仍保存最后收到的字符）
+#if defined(USART_RDR_RDR)
+#define UART_RX_DATA(huart) ((huart)->Instance->RDR)
+#else
+#define UART_RX_DATA(huart) ((huart)->Instance->DR)
+#endif
+
+// 接收事件是否为线路空闲（DMA接收）
+#if defined(HAL_UART_RXEVENT_IDLE)
+#define UART_RX_EVENT_IS_IDLE(huart, pos) (HAL_UARTEx_GetRxEventType(huart) == HAL_UART_RXEVENT_IDLE)
+#else
+// 旧版HAL不区分事件类型：不在半满/满位置的事件是线路空闲
+#define UART_RX_EVENT_IS_IDLE(huart, pos) ((pos) != UART_RX_DMA_SIZE / 2 && (pos) != UART_RX_DMA_SIZE)
+#endif
+
+// 待分发的接收事件位：低位为uart_event_type_t，高位为空闲定时器的内部请求
+#define UART_EVT_BIT(type) (1u << (type))
+#define UART_EVT_ARM_IDLE (1u << 30) // 收到数据，需要启动空闲定时器
+#define UART_EVT_IDLE (1u << 31)     // 空闲定时器到期
+
+#if UART_STATS_ENABLE
+// 同时跟踪发送延迟的写入次数（多出的写入不抽样）
+#define UART_LAT_SAMPLES 4
+
+// 发送延迟抽样：写入结束位置（累计字节数）和写入时间
+typedef struct
+{
+    uint32_t mark;
+    uint32_t stamp; // DWT周期
+} uart_lat_sample_t;
+
+static uint32_t uart_cycles_per_us = 1;
+
+#define UART_STAT_ADD(device, field, n) ((device)->stats.field += (n))
+#else
+#define UART_STAT_ADD(device, field, n) ((void)0)
+#endif
+
 // UART设备结构体
 typedef struct
 {
-    UART_HandleTypeDef *hal_uart;   // HAL UART句柄
-    StreamBufferHandle_t tx_stream; // 发送流缓冲区
-    StreamBufferHandle_t rx_stream; // 接收流缓冲区
-    SemaphoreHandle_t tx_mutex;     // 发送互斥锁
-    SemaphoreHandle_t rx_mutex;     // 接收互斥锁
-    bool initialized;               // 初始化标志
-    bool tx_busy;                   // 发送忙标志
-    uint32_t tx_buffer_size;        // 发送缓冲区大小
-    uint32_t rx_buffer_size;        // 接收缓冲区大小
-    uint8_t tx_temp_buffer[64];     // 临时发送缓冲区
-    uint8_t rx_temp_buffer[64];     // 临时接收缓冲区
-} uart_device_t;
+    UART_HandleTypeDef *hal_uart;            // HAL UART句柄
+    uart_ring_t tx_ring;                     // 发送环形缓冲区（DMA直接从中发送）
+    uart_ring_t rx_ring;                     // 接收环形缓冲区（接收中断写入，持有接收互斥锁的任务读取）
+    SemaphoreHandle_t tx_mutex;              // 发送互斥锁
+    SemaphoreHandle_t rx_mutex;              // 接收互斥锁（同一时间只有一个读取者）
+    SemaphoreHandle_t tx_space_sem;          // 发送完成释放空间时通知写入者
+    SemaphoreHandle_t rx_data_sem;           // 接收数据满足等待条件时通知读取者
+    bool initialized;                        // 初始化标志
+    bool tx_busy;                            // 发送忙标志
+    uint8_t mode;                            // 收发方式（uart_xfer_mode_t）
+    bool tx_dma;                             // 发送使用DMA
+    bool rx_dma;                             // 接收使用DMA
+    uint32_t tx_buffer_size;                 // 发送缓冲区大小
+    uint32_t rx_buffer_size;                 // 接收缓冲区大小
+    volatile uint32_t tx_len;                // 正在发送的字节数（发送完成后从环形缓冲区释放）
+    volatile bool tx_discard;                // 发送完成后丢弃剩余数据（uart_clear时正在发送）
+    volatile bool tx_waiting;                // 有任务在等待发送空间或发送结束
+    uart_tx_req_t *tx_req_head;              // 异步发送请求队列（先进先出）
+    uart_tx_req_t *tx_req_tail;              // 异步发送请求队列尾
+    uart_tx_req_t *tx_cur_req;               // 正在发送的请求（NULL表示正在发送缓冲区数据）
+    uint32_t tx_committed;                   // 写入发送缓冲区的累计字节数（写入方修改）
+    volatile uint32_t tx_sent;               // 缓冲区中已发送完的累计字节数（发送完成中断修改）
+    volatile uint32_t rx_wait_bytes;         // 读取者等待缓冲区中有这么多字节，0表示没有读取者在等待
+    volatile int16_t rx_wait_delim;          // 读取者等待的分隔符，-1表示只按字节数唤醒
+    volatile bool rx_discard;                // uart_clear时读取者正在等待，由读取者丢弃接收数据
+    uart_event_cb_t rx_evt_cb;               // 接收事件回调（NULL表示不上报事件）
+    uint32_t rx_evt_min_bytes;               // 缓冲数据达到该字节数时上报数据事件，0表示不按字节数
+    uint32_t rx_evt_idle_us;                 // 设置的空闲上报时间（微秒），0表示不按空闲
+    TickType_t rx_evt_idle_ticks;            // 线路空闲该时间后上报数据事件，0表示不按tick计时
+    volatile bool rx_evt_idle_hw;            // 由硬件空闲事件上报（空闲时间不超过一个字符时间）
+    int16_t rx_pattern;                      // 模式检测字符，-1表示不检测
+    volatile uint32_t rx_evt_pending;        // 待分发的事件位（中断中置位，worker中取走）
+    volatile bool rx_evt_running;            // 正在分发事件（多线程worker中保证回调串行）
+    volatile bool rx_idle_armed;             // 空闲定时器已启动
+    volatile uint32_t rx_total;              // 写入接收缓冲区的累计字节数（中断中修改）
+    volatile uint32_t rx_pattern_end;        // 最后一个模式字符之后的累计字节位置
+    uint32_t rx_reported;                    // 上次上报数据事件时的rx_total
+    volatile TickType_t rx_last_tick;        // 最后一次收到数据的tick
+    uart_rts_set_t rts_set;                  // RTS控制（NULL表示不使用RTS流控）
+    uint32_t rts_high;                       // 接收缓冲数据达到该值时撤销RTS
+    uint32_t rts_low;                        // 读取后降到该值以下时恢复RTS
+    volatile bool rts_ready;                 // 当前RTS状态（true：允许对方发送）
+    bool rs485;                              // RS-485半双工模式
+    bool rs485_echo;                         // 丢弃发送期间收到的数据（回波）
+    uart_de_set_t rs485_de;                  // DE控制（NULL表示硬件DE或单线半双工）
+    volatile bool rs485_tx;                  // 正在发送：DE有效，收到的数据是回波
+    uint8_t rx_byte;                         // 中断模式单字节接收
+    volatile uint16_t rx_dma_pos;            // 环形DMA缓冲区读位置（之前的数据已写入rx_ring）
+    uint8_t rx_dma_buffer[UART_RX_DMA_SIZE]; // 环形DMA接收缓冲区
+    worker_work_t tx_work;                   // 发送工作对象（已排队时重复触发不会重复入队）
+    worker_work_t rx_start_work;             // 启动接收工作对象
+    worker_timer_t rx_poll_timer;            // 轮询模式：定时读取接收
+    worker_work_t rx_evt_work;               // 接收事件分发工作对象
+    worker_timer_t rx_idle_timer;            // 接收空闲定时器
+#if UART_STATS_ENABLE
+    uart_stats_t stats;                             // 统计（计数只在中断中或持有发送互斥锁时修改）
+    uart_lat_sample_t lat_samples[UART_LAT_SAMPLES]; // 发送延迟抽样
+    uint32_t lat_head;                              // 抽样写位置（写入者修改）
+    uint32_t lat_tail;                              // 抽样读位置（发送完成中断修改）
+#endif
+#if UART_STATIC_ALLOC
+    StaticSemaphore_t tx_mutex_buf;     // 发送互斥锁控制块
+    StaticSemaphore_t rx_mutex_buf;     // 接收互斥锁控制块
+    StaticSemaphore_t tx_space_buf;     // 发送空间信号量控制块
+    StaticSemaphore_t rx_data_buf;      // 接收数据信号量控制块
+#endif
+} uart_device_t;
+
+// UART设备实例数组
+static uart_device_t uart_devices[UART_NUM_MAX] = {0};
+
+// 端口表中的HAL UART句柄（由CubeMX在具体项目中定义）
+#define UART_PORT_EXTERN(port, handle, mode, tx_size, rx_size) extern UART_HandleTypeDef handle;
+UART_PORT_TABLE(UART_PORT_EXTERN)
+#undef UART_PORT_EXTERN
+
+#if UART_STATIC_ALLOC
+// 每个端口的收发环形缓冲区存储（接收多一个字节区分满和空）
+#define UART_PORT_STORAGE(port, handle, mode, tx_size, rx_size)         \
+    UART_STATIC_SECTION static uint8_t uart_tx_storage_##port[tx_size]; \
+    UART_STATIC_SECTION static uint8_t uart_rx_storage_##port[(rx_size) + 1];
+UART_PORT_TABLE(UART_PORT_STORAGE)
+#undef UART_PORT_STORAGE
+#endif
+
+static void uart_tx_complete(uart_device_t *device);
+static void uart_rx_complete(uart_device_t *device);
+static void uart_rx_event(uart_device_t *device, uint16_t pos);
+static void uart_error(uart_device_t *device);
+static void uart_rs485_tx_begin(uart_device_t *device, BaseType_t *higher_prio_woken);
+static void uart_rs485_tx_end(uart_device_t *device, BaseType_t *higher_prio_woken);
+#if UART_TX_ISR_CHAIN
+static void uart_tx_dma_complete(uart_device_t *device);
+#endif
+
+// 每个端口的HAL回调入口：端口号在编译时确定，中断中不需要按句柄查找端口
+#if UART_TX_ISR_CHAIN
+#define UART_PORT_DMA_CALLBACK(port)                                   \
+    static void uart_tx_dma_cplt_##port(DMA_HandleTypeDef *hdma)       \
+    {                                                                  \
+        (void)hdma;                                                    \
+        uart_tx_dma_complete(&uart_devices[port]);                     \
+    }
+#else
+#define UART_PORT_DMA_CALLBACK(port)
+#endif
+
+#define UART_PORT_CALLBACKS(port, handle, mode, tx_size, rx_size)              \
+    static void uart_tx_cplt_##port(UART_HandleTypeDef *huart)                 \
+    {                                                                          \
+        (void)huart;                                                           \
+        uart_tx_complete(&uart_devices[port]);                                 \
+    }                                                                          \
+    static void uart_rx_cplt_##port(UART_HandleTypeDef *huart)                 \
+    {                                                                          \
+        (void)huart;                                                           \
+        uart_rx_complete(&uart_devices[port]);                                 \
+    }                                                                          \
+    static void uart_rx_event_##port(UART_HandleTypeDef *huart, uint16_t pos)  \
+    {                                                                          \
+        (void)huart;                                                           \
+        uart_rx_event(&uart_devices[port], pos);                               \
+    }                                                                          \
+    static void uart_error_##port(UART_HandleTypeDef *huart)                   \
+    {                                                                          \
+        (void)huart;                                                           \
+        uart_error(&uart_devices[port]);                                       \
+    }                                                                          \
+    UART_PORT_DMA_CALLBACK(port)
+UART_PORT_TABLE(UART_PORT_CALLBACKS)
+#undef UART_PORT_CALLBACKS
+
+// 端口配置（由端口表生成）
+typedef struct
+{
+    UART_HandleTypeDef *huart; // HAL句柄
+    uint8_t mode;              // 收发方式（uart_xfer_mode_t）
+    uint32_t tx_size;          // 默认发送缓冲区大小（静态分配模式下为存储大小）
+    uint32_t rx_size;          // 默认接收缓冲区大小
+#if UART_STATIC_ALLOC
+    uint8_t *tx_storage; // 发送环形缓冲区存储
+    uint8_t *rx_storage; // 接收环形缓冲区存储（rx_size + 1字节）
+#endif
+    void (*tx_cplt)(UART_HandleTypeDef *huart);
+    void (*rx_cplt)(UART_HandleTypeDef *huart);
+    void (*rx_event)(UART_HandleTypeDef *huart, uint16_t pos);
+    void (*error)(UART_HandleTypeDef *huart);
+#if UART_TX_ISR_CHAIN
+    void (*dma_tx_cplt)(DMA_HandleTypeDef *hdma);
+#endif
+} uart_port_cfg_t;
+
+#if UART_STATIC_ALLOC
+#define UART_PORT_CFG_STORAGE(port) .tx_storage = uart_tx_storage_##port, .rx_storage = uart_rx_storage_##port,
+#else
+#define UART_PORT_CFG_STORAGE(port)
+#endif
+#if UART_TX_ISR_CHAIN
+#define UART_PORT_CFG_DMA(port) .dma_tx_cplt = uart_tx_dma_cplt_##port,
+#else
+#define UART_PORT_CFG_DMA(port)
+#endif
+
+#define UART_PORT_CFG(port, handle, xfer_mode, tx_buf_size, rx_buf_size) \
+    [port] = {                                                          \
+        .huart = &handle,                                               \
+        .mode = xfer_mode,                                              \
+        .tx_size = tx_buf_size,                                         \
+        .rx_size = rx_buf_size,                                         \
+        UART_PORT_CFG_STORAGE(port)                                     \
+        .tx_cplt = uart_tx_cplt_##port,                                 \
+        .rx_cplt = uart_rx_cplt_##port,                                 \
+        .rx_event = uart_rx_event_##port,                               \
+        .error = uart_error_##port,                                     \
+        UART_PORT_CFG_DMA(port)                                         \
+    },
+static const uart_port_cfg_t uart_port_cfgs[UART_NUM_MAX] = {
+    UART_PORT_TABLE(UART_PORT_CFG)
+};
+#undef UART_PORT_CFG
+#if UART_SHELL_CMD
+static void uart_shell_register(void);
+#endif
+
+#if UART_STATS_ENABLE
+static inline void uart_stat_max(uint32_t *field, uint32_t value)
+{
+    if (value > *field)
+    {
+        *field = value;
+    }
+}
+
+/**
+ * @brief 写入前记录抽样：缓冲区数据发送到mark（本次写入的结束位置）时计算延迟
+ *
+ * 调用者持有发送互斥锁。抽样要在复制前入队，接续发送可能在写入返回前就发完这些数据。
+ *
+ * @return true:已抽样 false:正在跟踪的抽样已满
+ */
+static bool uart_stats_tx_mark(uart_device_t *device, uint32_t mark)
+{
+    uint32_t head = device->lat_head;
+
+    if (head - __atomic_load_n(&device->lat_tail, __ATOMIC_ACQUIRE) >= UART_LAT_SAMPLES)
+    {
+        return false;
+    }
+
+    uart_lat_sample_t *sample = &device->lat_samples[head % UART_LAT_SAMPLES];
+    sample->mark = mark;
+    sample->stamp = dwt_get_cycles();
+    __atomic_store_n(&device->lat_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// 缓冲区数据发送到tx_sent：结束已发完的抽样，计入延迟直方图（中断中调用）
+static void uart_stats_tx_sent(uart_device_t *device)
+{
+    uint32_t tail = device->lat_tail;
+    uint32_t head = __atomic_load_n(&device->lat_head, __ATOMIC_ACQUIRE);
+
+    while (tail != head)
+    {
+        const uart_lat_sample_t *sample = &device->lat_samples[tail % UART_LAT_SAMPLES];
+        if ((int32_t)(device->tx_sent - sample->mark) < 0)
+        {
+            break;
+        }
+
+        uint32_t us = (dwt_get_cycles() - sample->stamp) / uart_cycles_per_us;
+        uint32_t bucket = 0;
+        for (uint32_t limit = 64; bucket < UART_STATS_LATENCY_BUCKETS - 1 && us >= limit; limit <<= 2)
+        {
+            bucket++;
+        }
+        device->stats.tx_latency[bucket]++;
+        uart_stat_max(&device->stats.tx_latency_max_us, us);
+        tail++;
+    }
+
+    __atomic_store_n(&device->lat_tail, tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 记录超时未全部写入（调用者持有发送互斥锁）
+ * @param sampled 本次写入已抽样：抽样的结束位置改为实际写入的位置
+ */
+static void uart_stats_tx_short(uart_device_t *device, size_t requested, size_t written, bool sampled)
+{
+    if (written >= requested)
+    {
+        return;
+    }
+
+    device->stats.tx_short_writes++;
+    device->stats.tx_short_bytes += requested - written;
+
+    if (sampled)
+    {
+        taskENTER_CRITICAL();
+        if (device->lat_tail != device->lat_head)
+        {
+            device->lat_samples[(device->lat_head - 1) % UART_LAT_SAMPLES].mark = device->tx_committed;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+// 记录写入者等待发送空间的时间（调用者持有发送互斥锁）
+static void uart_stats_tx_wait(uart_device_t *device, TickType_t waited)
+{
+    uint32_t ms = waited * portTICK_PERIOD_MS;
+
+    device->stats.tx_wait_count++;
+    device->stats.tx_wait_ms += ms;
+    uart_stat_max(&device->stats.tx_wait_max_ms, ms);
+}
+
+// 记录HAL报告的错误（中断中调用）
+static void uart_stats_error(uart_device_t *device, uint32_t error)
+{
+    if (error & HAL_UART_ERROR_ORE)
+    {
+        device->stats.overrun_errors++;
+    }
+    if (error & HAL_UART_ERROR_FE)
+    {
+        device->stats.framing_errors++;
+    }
+    if (error & HAL_UART_ERROR_NE)
+    {
+        device->stats.noise_errors++;
+    }
+    if (error & HAL_UART_ERROR_PE)
+    {
+        device->stats.parity_errors++;
+    }
+    if (error & HAL_UART_ERROR_DMA)
+    {
+        device->stats.dma_errors++;
+    }
+}
+#endif
+
+// 是否还有数据或异步请求等待发送
+static bool uart_tx_pending(uart_device_t *device)
+{
+    return !uart_ring_empty(&device->tx_ring) || device->tx_req_head != NULL;
+}
+
+/**
+ * @brief 占用发送并取出下一段要发送的数据（请求的缓冲区或发送环形缓冲区中的一段连续数据）
+ *
+ * 调用者持有临界区，或在UART/DMA中断中调用。
+ *
+ * @param max 本次最多发送的字节数
+ * @param len 输出：本次发送的字节数
+ * @return 数据位置，正在发送或没有数据时返回NULL
+ */
+static uint8_t *uart_tx_claim_locked(uart_device_t *device, uint32_t max, uint32_t *len_out)
+{
+    uint8_t *data;
+    uint32_t len;
+
+    if (device->tx_busy)
+    {
+        return NULL;
+    }
+
+    uart_tx_req_t *req = device->tx_req_head;
+    if (req != NULL && req->mark == device->tx_sent)
+    {
+        // 请求之前写入的数据已发完：DMA直接从请求的缓冲区发送
+        data = (uint8_t *)req->data + req->sent;
+        len = req->len - req->sent;
+        device->tx_cur_req = req;
+    }
+    else
+    {
+        data = uart_ring_read_acquire(&device->tx_ring, &len);
+        if (data == NULL)
+        {
+            return NULL;
+        }
+        // 有请求在排队时只发送排在它前面的数据
+        if (req != NULL && len > req->mark - device->tx_sent)
+        {
+            len = req->mark - device->tx_sent;
+        }
+        device->tx_cur_req = NULL;
+    }
+    if (len > max)
+    {
+        len = max;
+    }
+    device->tx_len = len;
+    device->tx_busy = true;
+
+    *len_out = len;
+    return data;
+}
+
+// 放弃占用的发送（数据留在缓冲区）
+static void uart_tx_unclaim_locked(uart_device_t *device)
+{
+    device->tx_len = 0;
+    device->tx_cur_req = NULL;
+    device->tx_busy = false;
+}
+
+/**
+ * @brief 取出下一段数据启动DMA（或中断）发送，数据原地发送不复制
+ *
+ * 调用者持有临界区，或在UART/DMA中断中调用。
+ *
+ * @return true:已启动 false:正在发送、没有数据或外设被占用
+ */
+static bool uart_tx_start_locked(uart_device_t *device, BaseType_t *higher_prio_woken)
+{
+    UART_HandleTypeDef *huart = device->hal_uart;
+    uint32_t len;
+    uint8_t *data = uart_tx_claim_locked(device, UART_TX_XFER_MAX, &len);
+
+    if (data == NULL)
+    {
+        return false;
+    }
+
+    if (device->rs485 && !device->rs485_tx)
+    {
+        uart_rs485_tx_begin(device, higher_prio_woken);
+    }
+
+    HAL_StatusTypeDef ret;
+    if (device->tx_dma)
+    {
+        ret = HAL_UART_Transmit_DMA(huart, data, (uint16_t)len);
+#if UART_TX_ISR_CHAIN
+        // 接管DMA传输完成回调（中断已屏蔽，DMA完成中断不会先于这里执行）
+        if (ret == HAL_OK)
+        {
+            huart->hdmatx->XferCpltCallback = uart_port_cfgs[device - uart_devices].dma_tx_cplt;
+        }
+#endif
+    }
+    else
+    {
+        ret = HAL_UART_Transmit_IT(huart, data, (uint16_t)len);
+    }
+
+    if (ret != HAL_OK)
+    {
+        // 外设被占用：数据留在缓冲区，下一次写入或uart_flush时重试
+        uart_tx_unclaim_locked(device);
+        uart_rs485_tx_end(device, higher_prio_woken);
+        return false;
+    }
+    UART_STAT_ADD(device, tx_xfers, 1);
+
+    // 注意：发送完成后会在回调函数中释放这段数据、清除tx_busy标志并继续处理下一段
+    return true;
+}
+
+static void uart_tx_start(uart_device_t *device)
+{
+    BaseType_t woken = pdFALSE;
+
+    // tx_work在多线程工作队列上可能同时被两个线程执行，占用发送必须是原子的；
+    // 启动也在临界区内：错误中断看到tx_busy时HAL的发送状态已经是忙
+    taskENTER_CRITICAL();
+    uart_tx_start_locked(device, &woken);
+    taskEXIT_CRITICAL();
+
+    if (woken == pdTRUE)
+    {
+        taskYIELD();
+    }
+}
+
+// 异步发送请求的完成回调（worker线程中执行）
+static void uart_tx_req_work(void *arg)
+{
+    uart_tx_req_t *req = (uart_tx_req_t *)arg;
+
+    req->cb(req, req->result);
+}
+
+// 异步发送请求结束：完成回调交给worker线程执行（中断中或临界区内调用）
+static void uart_tx_req_complete(uart_tx_req_t *req, esp_err_t result, BaseType_t *higher_prio_woken)
+{
+    req->next = NULL;
+    req->result = result;
+    req->state = UART_TX_REQ_DONE;
+
+    if (req->cb)
+    {
+        worker_queue_work_from_isr(&req->work, higher_prio_woken);
+    }
+}
+
+// 从请求队列中移除请求（调用者持有临界区）
+static void uart_tx_req_unlink(uart_device_t *device, uart_tx_req_t *req)
+{
+    uart_tx_req_t **pp = &device->tx_req_head;
+    uart_tx_req_t *prev = NULL;
+
+    while (*pp)
+    {
+        if (*pp == req)
+        {
+            *pp = req->next;
+            if (device->tx_req_tail == req)
+            {
+                device->tx_req_tail = prev;
+            }
+            return;
+        }
+        prev = *pp;
+        pp = &(*pp)->next;
+    }
+}
+
+/**
+ * @brief 丢弃还没开始发送的数据（中断中或临界区内调用，uart_clear持有发送互斥锁）
+ * @return 被取消的请求链表
+ */
+static uart_tx_req_t *uart_tx_discard_locked(uart_device_t *device)
+{
+    uart_tx_req_t *list = device->tx_req_head;
+
+    uart_ring_read_discard(&device->tx_ring);
+    device->tx_sent = device->tx_committed;
+    device->tx_req_head = NULL;
+    device->tx_req_tail = NULL;
+    device->tx_discard = false;
+#if UART_STATS_ENABLE
+    // 丢弃的数据不计延迟
+    device->lat_tail = device->lat_head;
+#endif
+
+    return list;
+}
+
+/**
+ * @brief 结束当前发送的一段（中断中调用）
+ * @param result ESP_OK:已发送 其他:发送中止，缓冲区数据丢弃，请求以该结果结束
+ */
+static void uart_tx_finish(uart_device_t *device, esp_err_t result, BaseType_t *higher_prio_woken)
+{
+    uart_tx_req_t *req = device->tx_cur_req;
+
+    if (result == ESP_OK)
+    {
+        UART_STAT_ADD(device, tx_bytes, device->tx_len);
+    }
+
+    if (req != NULL)
+    {
+        req->sent += device->tx_len;
+        if (result != ESP_OK || req->sent >= req->len)
+        {
+            uart_tx_req_unlink(device, req);
+            uart_tx_req_complete(req, result, higher_prio_woken);
+        }
+        device->tx_cur_req = NULL;
+    }
+    else
+    {
+        uart_ring_read_release(&device->tx_ring, device->tx_len);
+        device->tx_sent += device->tx_len;
+#if UART_STATS_ENABLE
+        uart_stats_tx_sent(device);
+#endif
+    }
+    device->tx_len = 0;
+
+    if (device->tx_discard)
+    {
+        // uart_clear期间正在发送：其后的数据在这里丢弃，排队的请求取消
+        req = uart_tx_discard_locked(device);
+        while (req)
+        {
+            uart_tx_req_t *next = req->next;
+            uart_tx_req_complete(req, ESP_FAIL, higher_prio_woken);
+            req = next;
+        }
+    }
+}
+
+// 通知等待的任务：只在有写入者等待空间，或数据全部发送完（uart_flush）时通知
+static void uart_tx_notify_from_isr(uart_device_t *device, BaseType_t *higher_prio_woken)
+{
+    if (device->tx_waiting || (!device->tx_busy && !uart_tx_pending(device)))
+    {
+        device->tx_waiting = false;
+        xSemaphoreGiveFromISR(device->tx_space_sem, higher_prio_woken);
+    }
+}
+
+/**
+ * @brief 轮询模式发送一块数据（worker线程中执行）
+ *
+ * 每次最多阻塞发送UART_POLL_TX_CHUNK字节，还有数据时重新排队，其他工作项可以穿插执行。
+ */
+static void uart_tx_poll(uart_device_t *device)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t len;
+
+    taskENTER_CRITICAL();
+    uint8_t *data = uart_tx_claim_locked(device, UART_POLL_TX_CHUNK, &len);
+    taskEXIT_CRITICAL();
+    if (data == NULL)
+    {
+        return;
+    }
+
+    // 超时只用于外设异常，UART_POLL_TX_CHUNK字节在1200波特率下约0.5秒
+    HAL_StatusTypeDef ret = HAL_UART_Transmit(device->hal_uart, data, (uint16_t)len, 1000);
+
+    taskENTER_CRITICAL();
+    if (ret == HAL_OK)
+    {
+        UART_STAT_ADD(device, tx_xfers, 1);
+    }
+    uart_tx_finish(device, (ret == HAL_OK) ? ESP_OK : ESP_FAIL, &woken);
+    device->tx_busy = false;
+    uart_tx_notify_from_isr(device, &woken);
+    taskEXIT_CRITICAL();
+
+    if (uart_tx_pending(device))
+    {
+        worker_queue_work(&device->tx_work);
+    }
+    if (woken == pdTRUE)
+    {
+        taskYIELD();
+    }
+}
+
+// Worker任务：处理发送数据（非阻塞版本）
+static void uart_tx_worker_task(void *arg)
+{
+    uart_port_t port = (uart_port_t)(uintptr_t)arg;
+    uart_device_t *device = &uart_devices[port];
+
+    if (!device->initialized)
+    {
+        return;
+    }
+
+    if (device->mode == UART_XFER_POLL)
+    {
+        uart_tx_poll(device);
+        return;
+    }
+
+    uart_tx_start(device);
+}
+
+// 有数据且发送空闲时提交发送工作
+static void uart_tx_kick(uart_device_t *device)
+{
+    if (!device->tx_busy && uart_tx_pending(device))
+    {
+        worker_queue_work(&device->tx_work);
+    }
+}
+
+// 启动接收的Worker任务
+static void uart_rx_start_worker_task(void *arg)
+{
+    uart_port_t port = (uart_port_t)(uintptr_t)arg;
+    uart_device_t *device = &uart_devices[port];
+    UART_HandleTypeDef *huart = device->hal_uart;
+
+    if (!device->initialized)
+    {
+        return;
+    }
+
+    // 轮询模式：定时读取
+    if (device->mode == UART_XFER_POLL)
+    {
+        worker_send_periodic(&device->rx_poll_timer, UART_POLL_RX_PERIOD_MS);
+        return;
+    }
+
+    // 启动DMA接收或中断接收：只在接收已停止时启动，重复的启动请求（错误中断排队的启动晚于
+    // 切换波特率后的启动）不能复位正在进行的环形DMA的读位置，否则已取走的数据会被再次写入
+    taskENTER_CRITICAL();
+    if (huart->RxState == HAL_UART_STATE_READY)
+    {
+        if (device->rx_dma)
+        {
+            // DMA通道固定为循环模式：接收不间断，由半满/满/空闲事件报告写位置
+            if (huart->hdmarx->Init.Mode != DMA_CIRCULAR)
+            {
+                huart->hdmarx->Init.Mode = DMA_CIRCULAR;
+                HAL_DMA_Init(huart->hdmarx);
+            }
+
+            device->rx_dma_pos = 0;
+            HAL_UARTEx_ReceiveToIdle_DMA(huart, device->rx_dma_buffer, UART_RX_DMA_SIZE);
+        }
+        else
+        {
+            HAL_UART_Receive_IT(huart, &device->rx_byte, 1);
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+// 重新启动接收（任务中调用）：交给rx_start_work，与错误中断排队的启动合并
+static void uart_rx_restart(uart_device_t *device)
+{
+    if (worker_queue_work(&device->rx_start_work) < 0)
+    {
+        // 节点池满时直接启动（接收已在运行时不会重复启动）
+        uart_rx_start_worker_task((void *)(uintptr_t)(device - uart_devices));
+    }
+}
+
+// 记录待分发的接收事件，由worker线程合并分发（中断中调用）
+static void uart_rx_event_post(uart_device_t *device, uint32_t bits, BaseType_t *higher_prio_woken)
+{
+    __atomic_fetch_or(&device->rx_evt_pending, bits, __ATOMIC_RELEASE);
+    worker_queue_work_from_isr(&device->rx_evt_work, higher_prio_woken);
+}
+
+/**
+ * @brief 检查新写入的pushed字节是否产生接收事件（中断中调用）
+ * @param len 收到的字节数（多出pushed的部分因缓冲区满被丢弃）
+ * @param used 写入后缓冲的字节数
+ */
+static void uart_rx_event_check(uart_device_t *device, const uint8_t *data, size_t len, size_t pushed, uint32_t used,
+                                BaseType_t *higher_prio_woken)
+{
+    uint32_t bits = 0;
+    uint32_t start = device->rx_total;
+
+    if (pushed < len)
+    {
+        bits |= UART_EVT_BIT(UART_EVENT_BUFFER_FULL);
+    }
+    if (pushed > 0)
+    {
+        device->rx_total = start + pushed;
+        device->rx_last_tick = xTaskGetTickCountFromISR();
+
+        if (device->rx_pattern >= 0)
+        {
+            // 记录本批数据中最后一个模式字符的位置
+            const uint8_t *last = NULL;
+            const uint8_t *p = data;
+            while ((p = memchr(p, device->rx_pattern, data + pushed - p)) != NULL)
+            {
+                last = p++;
+            }
+            if (last != NULL)
+            {
+                device->rx_pattern_end = start + (uint32_t)(last - data) + 1;
+                bits |= UART_EVT_BIT(UART_EVENT_PATTERN_DET);
+            }
+        }
+
+        if (device->rx_evt_min_bytes > 0 && used >= device->rx_evt_min_bytes)
+        {
+            bits |= UART_EVT_BIT(UART_EVENT_DATA);
+        }
+        else if (device->rx_evt_idle_ticks > 0 && !device->rx_idle_armed)
+        {
+            bits |= UART_EVT_ARM_IDLE;
+        }
+    }
+
+    if (bits != 0)
+    {
+        uart_rx_event_post(device, bits, higher_prio_woken);
+    }
+}
+
+/**
+ * @brief 接收数据写入rx_ring，缓冲区满时多出的数据丢弃（中断中调用）
+ *
+ * 只在满足读取者的等待条件时通知：缓冲数据达到等待的字节数，或新数据中有等待的分隔符
+ * （memchr逐字查找），按行读取时每行只唤醒一次读取者。
+ */
+static void uart_rx_push(uart_device_t *device, const uint8_t *data, size_t len, BaseType_t *higher_prio_woken)
+{
+    size_t pushed = 0;
+
+    if (device->rs485_tx && device->rs485_echo)
+    {
+        // RS-485发送期间收到的是自己发出的数据
+        UART_STAT_ADD(device, rx_echo, len);
+        return;
+    }
+
+    while (pushed < len)
+    {
+        uint32_t n;
+        uint8_t *dst = uart_ring_write_reserve_max(&device->rx_ring, len - pushed, &n);
+        if (dst == NULL)
+        {
+            break;
+        }
+        memcpy(dst, data + pushed, n);
+        uart_ring_write_commit(&device->rx_ring, n);
+        pushed += n;
+    }
+
+    uint32_t used = uart_ring_used(&device->rx_ring);
+#if UART_STATS_ENABLE
+    device->stats.rx_bytes += pushed;
+    device->stats.rx_dropped += len - pushed;
+    uart_stat_max(&device->stats.rx_high_water, used);
+#endif
+    if (device->rts_set != NULL && device->rts_ready && used >= device->rts_high)
+    {
+        // 达到高水位：要求对方暂停，读取方取走数据降到低水位后恢复
+        device->rts_ready = false;
+        device->rts_set((uart_port_t)(device - uart_devices), false);
+        UART_STAT_ADD(device, rts_stalls, 1);
+    }
+    if (device->rx_evt_cb != NULL)
+    {
+        uart_rx_event_check(device, data, len, pushed, used, higher_prio_woken);
+    }
+
+    uint32_t want = device->rx_wait_bytes;
+    if (want == 0 || pushed == 0)
+    {
+        return;
+    }
+    int delim = device->rx_wait_delim;
+    if (used >= want || (delim >= 0 && memchr(data, delim, pushed) != NULL))
+    {
+        device->rx_wait_bytes = 0;
+        xSemaphoreGiveFromISR(device->rx_data_sem, higher_prio_woken);
+    }
+}
+
+/**
+ * @brief 把环形DMA缓冲区中上次读位置到pos之间的新数据写入rx_ring（中断中调用）
+ * @param pos DMA写位置（0~UART_RX_DMA_SIZE）
+ *
+ * 每个字节只在读位置越过它时复制一次，半满、满和空闲事件先后报告同一段数据也不会重复。
+ * 两次事件之间DMA写入超过一整圈时旧数据被覆盖，UART_RX_DMA_SIZE需按波特率和中断延迟选择。
+ */
+static void uart_rx_dma_push(uart_device_t *device, uint16_t pos, BaseType_t *higher_prio_woken)
+{
+    uint16_t old_pos = device->rx_dma_pos;
+
+    if (pos > UART_RX_DMA_SIZE || pos == old_pos)
+    {
+        return;
+    }
+
+    if (pos > old_pos)
+    {
+        uart_rx_push(device, &device->rx_dma_buffer[old_pos], pos - old_pos, higher_prio_woken);
+    }
+    else
+    {
+        // DMA已回绕：先取到缓冲区末尾，再取开头
+        uart_rx_push(device, &device->rx_dma_buffer[old_pos], UART_RX_DMA_SIZE - old_pos, higher_prio_woken);
+        if (pos > 0)
+        {
+            uart_rx_push(device, device->rx_dma_buffer, pos, higher_prio_woken);
+        }
+    }
+
+    device->rx_dma_pos = (pos == UART_RX_DMA_SIZE) ? 0 : pos;
+}
+
+// 取走DMA已写入但还没有事件报告的数据（中断中或临界区内调用）
+static void uart_rx_dma_sync(uart_device_t *device, BaseType_t *higher_prio_woken)
+{
+    UART_HandleTypeDef *huart = device->hal_uart;
+
+    if (device->rx_dma && huart->RxState == HAL_UART_STATE_BUSY_RX)
+    {
+        uart_rx_dma_push(device, UART_RX_DMA_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx), higher_prio_woken);
+    }
+}
+
+/**
+ * @brief RS-485开始发送：使能DE（中断中或临界区内调用）
+ *
+ * 之前收到的数据先从DMA缓冲区取走，之后收到的才按回波丢弃。
+ */
+static void uart_rs485_tx_begin(uart_device_t *device, BaseType_t *higher_prio_woken)
+{
+    uart_rx_dma_sync(device, higher_prio_woken);
+    device->rs485_tx = true;
+    if (device->rs485_de != NULL)
+    {
+        device->rs485_de((uart_port_t)(device - uart_devices), true);
+    }
+}
+
+/**
+ * @brief RS-485发送结束：没有正在发送和等待发送的数据时释放DE（中断中或临界区内调用）
+ *
+ * 在TC中断中调用，最后一个字节的停止位发完就释放总线，不需要忙等。
+ * 最后一个字节的回波在TC之前已收到，先按回波取走再恢复接收。
+ */
+static void uart_rs485_tx_end(uart_device_t *device, BaseType_t *higher_prio_woken)
+{
+    if (!device->rs485_tx || device->tx_busy || uart_tx_pending(device))
+    {
+        return;
+    }
+
+    if (device->rs485_de != NULL)
+    {
+        device->rs485_de((uart_port_t)(device - uart_devices), false);
+    }
+    uart_rx_dma_sync(device, higher_prio_woken);
+    device->rs485_tx = false;
+}
+
+// 轮询模式：读取接收寄存器中已收到的数据（worker定时执行）
+static void uart_rx_poll_work(void *arg)
+{
+    uart_device_t *device = (uart_device_t *)arg;
+    BaseType_t woken = pdFALSE;
+    uint8_t buf[16];
+    uint32_t len = 0;
+
+    if (!device->initialized)
+    {
+        return;
+    }
+
+    while (len < sizeof(buf) && HAL_UART_Receive(device->hal_uart, &buf[len], 1, 0) == HAL_OK)
+    {
+        len++;
+    }
+
+    if (len > 0)
+    {
+        // 与中断模式相同，接收环形缓冲区只有这一个写入方
+        taskENTER_CRITICAL();
+        UART_STAT_ADD(device, rx_events, 1);
+        uart_rx_push(device, buf, len, &woken);
+        taskEXIT_CRITICAL();
+    }
+    if (woken == pdTRUE)
+    {
+        taskYIELD();
+    }
+}
+
+static void uart_rx_event_emit(uart_device_t *device, uart_event_type_t type, size_t size, bool timeout)
+{
+    uart_event_t event = {
+        .type = type,
+        .size = size,
+        .timeout_flag = timeout,
+    };
+    uart_event_cb_t cb = device->rx_evt_cb;
+    if (cb != NULL)
+    {
+        cb((uart_port_t)(device - uart_devices), &event);
+    }
+}
+
+// 分发一批接收事件（worker线程中，同一端口同一时间只有一个线程分发）
+static void uart_rx_event_dispatch(uart_device_t *device, uint32_t bits)
+{
+    TickType_t rearm = 0;
+
+    if ((bits & UART_EVT_ARM_IDLE) && !device->rx_idle_armed && device->rx_evt_idle_ticks > 0)
+    {
+        device->rx_idle_armed = true;
+        worker_send_delayed(&device->rx_idle_timer, device->rx_evt_idle_ticks * portTICK_PERIOD_MS);
+    }
+
+    // 与接收中断互斥地取得空闲判定和缓冲状态
+    taskENTER_CRITICAL();
+    if (bits & UART_EVT_IDLE)
+    {
+        TickType_t since = xTaskGetTickCount() - device->rx_last_tick;
+        if (since < device->rx_evt_idle_ticks)
+        {
+            // 定时期间又收到了数据，从最后一次收到数据开始重新计时
+            rearm = device->rx_evt_idle_ticks - since;
+            bits &= ~UART_EVT_IDLE;
+        }
+        else
+        {
+            device->rx_idle_armed = false;
+        }
+    }
+    uint32_t used = uart_ring_used(&device->rx_ring);
+    uint32_t total = device->rx_total;
+    uint32_t pattern_end = device->rx_pattern_end;
+    taskEXIT_CRITICAL();
+
+    if (rearm != 0)
+    {
+        worker_send_delayed(&device->rx_idle_timer, rearm * portTICK_PERIOD_MS);
+    }
+
+    // 错误先于数据上报
+    static const uint8_t errors[] = {UART_EVENT_FIFO_OVF, UART_EVENT_BUFFER_FULL, UART_EVENT_BREAK,
+                                     UART_EVENT_FRAME_ERR, UART_EVENT_PARITY_ERR};
+    for (uint32_t i = 0; i < sizeof(errors); i++)
+    {
+        if (bits & UART_EVT_BIT(errors[i]))
+        {
+            uart_rx_event_emit(device, (uart_event_type_t)errors[i], used, false);
+        }
+    }
+
+    // 模式字符之后又收到了total - pattern_end字节，模式字符已被读走时不再上报
+    if ((bits & UART_EVT_BIT(UART_EVENT_PATTERN_DET)) && used > total - pattern_end)
+    {
+        uart_rx_event_emit(device, UART_EVENT_PATTERN_DET, used - (total - pattern_end), false);
+    }
+
+    // 上次上报之后有新数据才上报，使用者没有读取时不会重复上报同一批数据
+    if ((bits & (UART_EVT_BIT(UART_EVENT_DATA) | UART_EVT_IDLE)) && total != device->rx_reported && used > 0)
+    {
+        device->rx_reported = total;
+        uart_rx_event_emit(device, UART_EVENT_DATA, used, !(bits & UART_EVT_BIT(UART_EVENT_DATA)));
+    }
+}
+
+/**
+ * @brief 接收事件工作（worker线程中）
+ *
+ * 多线程worker中同一工作对象可能同时在两个线程上执行：只有一个线程分发，
+ * 另一个线程提交的事件位由正在分发的线程继续取走。
+ */
+static void uart_rx_event_work(void *arg)
+{
+    uart_device_t *device = (uart_device_t *)arg;
+
+    while (__atomic_load_n(&device->rx_evt_pending, __ATOMIC_ACQUIRE) != 0)
+    {
+        if (__atomic_exchange_n(&device->rx_evt_running, true, __ATOMIC_ACQUIRE))
+        {
+            return;
+        }
+        uint32_t bits;
+        while ((bits = __atomic_exchange_n(&device->rx_evt_pending, 0, __ATOMIC_ACQUIRE)) != 0)
+        {
+            uart_rx_event_dispatch(device, bits);
+        }
+        __atomic_store_n(&device->rx_evt_running, false, __ATOMIC_RELEASE);
+    }
+}
+
+// 空闲定时器到期（worker线程中）
+static void uart_rx_idle_work(void *arg)
+{
+    uart_device_t *device = (uart_device_t *)arg;
+
+    __atomic_fetch_or(&device->rx_evt_pending, UART_EVT_IDLE, __ATOMIC_RELEASE);
+    uart_rx_event_work(device);
+}
+
+#if UART_TX_ISR_CHAIN
+/**
+ * @brief DMA发送传输完成（中断中，替代HAL的UART_DMATransmitCplt）
+ *
+ * 此时最后一个字节刚进入数据寄存器，线路上还有约两个字符的发送时间，
+ * 在这里直接接上下一段DMA，连续的帧之间线路不空闲。
+ * 没有后续数据时按HAL原流程打开TC中断，发送真正结束后进入uart_tx_complete。
+ */
+static void uart_tx_dma_complete(uart_device_t *device)
+{
+    UART_HandleTypeDef *huart = device->hal_uart;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // 与HAL相同：结束本次DMA发送请求
+    huart->TxXferCount = 0U;
+    CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+
+    // DMA已读完这一段，空间可以释放
+    uart_tx_finish(device, ESP_OK, &xHigherPriorityTaskWoken);
+    device->tx_busy = false;
+    huart->gState = HAL_UART_STATE_READY;
+
+    bool started = uart_tx_start_locked(device, &xHigherPriorityTaskWoken);
+    if (!started)
+    {
+        // 线路上还有最后的字节，TC中断之后才算发送结束
+        device->tx_busy = true;
+        huart->gState = HAL_UART_STATE_BUSY_TX;
+    }
+    uart_tx_notify_from_isr(device, &xHigherPriorityTaskWoken);
+
+    if (!started)
+    {
+        __HAL_UART_ENABLE_IT(huart, UART_IT_TC);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+#endif
+
+// HAL回调：发送完成（线路空闲）
+static void uart_tx_complete(uart_device_t *device)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // 发送完成的数据从环形缓冲区释放（DMA接续模式下已在DMA完成时释放）
+    uart_tx_finish(device, ESP_OK, &xHigherPriorityTaskWoken);
+    device->tx_busy = false;
+
+#if UART_TX_ISR_CHAIN
+    // 在中断中直接启动下一段
+    uart_tx_start_locked(device, &xHigherPriorityTaskWoken);
+#else
+    // 检查是否还有数据需要发送，如果有则触发新的发送任务
+    if (uart_tx_pending(device))
+    {
+        worker_queue_work_from_isr(&device->tx_work, &xHigherPriorityTaskWoken);
+    }
+#endif
+    // 最后一个字节的停止位已发出（TC），没有后续数据时立即释放总线
+    uart_rs485_tx_end(device, &xHigherPriorityTaskWoken);
+
+    uart_tx_notify_from_isr(device, &xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// HAL回调：接收完成（中断模式单字节接收）
+static void uart_rx_complete(uart_device_t *device)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    UART_STAT_ADD(device, rx_events, 1);
+    uart_rx_push(device, &device->rx_byte, 1, &xHigherPriorityTaskWoken);
+
+    // 继续接收下一个字节
+    HAL_UART_Receive_IT(device->hal_uart, &device->rx_byte, 1);
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// HAL回调：接收事件（DMA半满、满或线路空闲），pos为DMA写位置
+static void uart_rx_event(uart_device_t *device, uint16_t pos)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    UART_STAT_ADD(device, rx_events, 1);
+    uart_rx_dma_push(device, pos, &xHigherPriorityTaskWoken);
+
+    // 线路已空闲一个字符时间，直接上报数据事件（没有新数据时分发中不会上报）
+    if (device->rx_evt_idle_hw && device->rx_evt_cb != NULL && UART_RX_EVENT_IS_IDLE(device->hal_uart, pos))
+    {
+        uart_rx_event_post(device, UART_EVT_IDLE, &xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// HAL回调：错误处理
+static void uart_error(uart_device_t *device)
+{
+    UART_HandleTypeDef *huart = device->hal_uart;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+#if UART_STATS_ENABLE
+    uart_stats_error(device, huart->ErrorCode);
+#endif
+
+    // 发送DMA出错时HAL已结束发送（gState回到就绪）：丢弃这一段，继续发送后面的数据
+    // 接收错误（溢出、噪声等）不影响正在进行的发送
+    if (device->tx_busy && huart->gState == HAL_UART_STATE_READY)
+    {
+        uart_tx_finish(device, ESP_FAIL, &xHigherPriorityTaskWoken);
+        device->tx_busy = false;
+        worker_queue_work_from_isr(&device->tx_work, &xHigherPriorityTaskWoken);
+        uart_tx_notify_from_isr(device, &xHigherPriorityTaskWoken);
+        uart_rs485_tx_end(device, &xHigherPriorityTaskWoken);
+    }
+
+    // HAL已停止DMA（溢出等错误），先取走停止前收到的数据
+    if (device->rx_dma)
+    {
+        uart_rx_dma_push(device, UART_RX_DMA_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx),
+                         &xHigherPriorityTaskWoken);
+    }
+
+    if (device->rx_evt_cb != NULL)
+    {
+        uint32_t error = huart->ErrorCode;
+        uint32_t bits = 0;
+        if (error & HAL_UART_ERROR_ORE)
+        {
+            bits |= UART_EVT_BIT(UART_EVENT_FIFO_OVF);
+        }
+        if (error & HAL_UART_ERROR_FE)
+        {
+            // break是持续一帧以上的低电平：帧错误且收到的数据为0
+            bits |= ((UART_RX_DATA(huart) & 0xFF) == 0) ? UART_EVT_BIT(UART_EVENT_BREAK)
+                                                        : UART_EVT_BIT(UART_EVENT_FRAME_ERR);
+        }
+        if (error & HAL_UART_ERROR_PE)
+        {
+            bits |= UART_EVT_BIT(UART_EVENT_PARITY_ERR);
+        }
+        if (bits != 0)
+        {
+            uart_rx_event_post(device, bits, &xHigherPriorityTaskWoken);
+        }
+    }
+
+    // 重新启动接收 - 通过Worker任务处理
+    worker_queue_work_from_isr(&device->rx_start_work, &xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// 释放发送环形缓冲区存储（静态分配模式下无需释放）
+static void uart_storage_free(uart_device_t *device)
+{
+#if !UART_STATIC_ALLOC
+    vPortFree(device->tx_ring.buf);
+    vPortFree(device->rx_ring.buf);
+#endif
+    device->tx_ring.buf = NULL;
+    device->rx_ring.buf = NULL;
+}
+
+// 初始化UART
+esp_err_t uart_async_init(uart_port_t port, uint32_t size)
+{
+    if (port >= UART_NUM_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uart_device_t *device = &uart_devices[port];
+
+    if (device->initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 端口表中的HAL句柄、收发方式和缓冲区大小
+    const uart_port_cfg_t *cfg = &uart_port_cfgs[port];
+    device->hal_uart = cfg->huart;
+    device->mode = cfg->mode;
+    device->tx_dma = (cfg->mode == UART_XFER_DMA && device->hal_uart->hdmatx != NULL);
+    device->rx_dma = (cfg->mode == UART_XFER_DMA && device->hal_uart->hdmarx != NULL);
+
+    uint32_t tx_size = (size != 0) ? size : cfg->tx_size;
+    uint32_t rx_size = (size != 0) ? size : cfg->rx_size;
+#if UART_STATIC_ALLOC
+    if (tx_size == 0 || tx_size > cfg->tx_size || rx_size == 0 || rx_size > cfg->rx_size)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+#else
+    if (tx_size == 0 || rx_size == 0)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+#endif
+    device->tx_buffer_size = tx_size;
+    device->rx_buffer_size = rx_size;
+
+    // 创建收发环形缓冲区（接收多留一个字节区分满和空，能缓存rx_size字节）
+#if UART_STATIC_ALLOC
+    uart_ring_init(&device->tx_ring, cfg->tx_storage, tx_size);
+    uart_ring_init(&device->rx_ring, cfg->rx_storage, rx_size + 1);
+#else
+    uint8_t *tx_storage = pvPortMalloc(tx_size);
+    uint8_t *rx_storage = pvPortMalloc(rx_size + 1);
+    uart_ring_init(&device->tx_ring, tx_storage, tx_size);
+    uart_ring_init(&device->rx_ring, rx_storage, rx_size + 1);
+    if (tx_storage == NULL || rx_storage == NULL)
+    {
+        uart_storage_free(device);
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    // 创建互斥锁
+#if UART_STATIC_ALLOC
+    device->tx_mutex = xSemaphoreCreateMutexStatic(&device->tx_mutex_buf);
+    device->rx_mutex = xSemaphoreCreateMutexStatic(&device->rx_mutex_buf);
+    device->tx_space_sem = xSemaphoreCreateBinaryStatic(&device->tx_space_buf);
+    device->rx_data_sem = xSemaphoreCreateBinaryStatic(&device->rx_data_buf);
+#else
+    device->tx_mutex = xSemaphoreCreateMutex();
+    device->rx_mutex = xSemaphoreCreateMutex();
+    device->tx_space_sem = xSemaphoreCreateBinary();
+    device->rx_data_sem = xSemaphoreCreateBinary();
+#endif
+
+    if (device->tx_mutex == NULL || device->rx_mutex == NULL || device->tx_space_sem == NULL ||
+        device->rx_data_sem == NULL)
+    {
+        // 清理资源
+        uart_storage_free(device);
+        if (device->tx_mutex)
+            vSemaphoreDelete(device->tx_mutex);
+        if (device->rx_mutex)
+            vSemaphoreDelete(device->rx_mutex);
+        if (device->tx_space_sem)
+            vSemaphoreDelete(device->tx_space_sem);
+        if (device->rx_data_sem)
+            vSemaphoreDelete(device->rx_data_sem);
+        return ESP_ERR_NO_MEM;
+    }
+
+    device->tx_len = 0;
+    device->tx_busy = false;
+    device->rx_wait_bytes = 0;
+    device->rx_wait_delim = -1;
+    device->rx_discard = false;
+    device->rx_evt_cb = NULL;
+    device->rx_pattern = -1;
+    device->rx_evt_pending = 0;
+    device->rx_idle_armed = false;
+    device->rts_set = NULL;
+    device->rts_ready = true;
+    device->rs485 = false;
+    device->rs485_echo = false;
+    device->rs485_de = NULL;
+    device->rs485_tx = false;
+#if UART_STATS_ENABLE
+    memset(&device->stats, 0, sizeof(device->stats));
+    device->lat_head = 0;
+    device->lat_tail = 0;
+    // 发送延迟用DWT周期计数器测量，已被其他模块启用时不再初始化
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        dwt_init();
+    }
+    if (get_system_clock_freq() >= 1000000)
+    {
+        uart_cycles_per_us = get_system_clock_freq() / 1000000;
+    }
+#endif
+#if UART_SHELL_CMD
+    uart_shell_register();
+#endif
+    device->initialized = true;
+
+    worker_work_init(&device->tx_work, uart_tx_worker_task, (void *)(uintptr_t)port, "UartTx");
+    worker_work_init(&device->rx_start_work, uart_rx_start_worker_task, (void *)(uintptr_t)port, "UartRxStart");
+    device->rx_start_work.item.flags = WORKER_FLAG_HIGH_PRIO;
+    worker_timer_init(&device->rx_poll_timer, uart_rx_poll_work, device, "UartRxPoll");
+    worker_work_init(&device->rx_evt_work, uart_rx_event_work, device, "UartRxEvt");
+    worker_timer_init(&device->rx_idle_timer, uart_rx_idle_work, device, "UartRxIdle");
+
+#if (USE_HAL_UART_REGISTER_CALLBACKS == 1)
+    // 注册本端口的HAL回调入口（轮询模式不使用中断）
+    if (device->mode != UART_XFER_POLL)
+    {
+        HAL_UART_RegisterCallback(device->hal_uart, HAL_UART_TX_COMPLETE_CB_ID, cfg->tx_cplt);
+        HAL_UART_RegisterCallback(device->hal_uart, HAL_UART_RX_COMPLETE_CB_ID, cfg->rx_cplt);
+        HAL_UART_RegisterCallback(device->hal_uart, HAL_UART_ERROR_CB_ID, cfg->error);
+        HAL_UART_RegisterRxEventCallback(device->hal_uart, cfg->rx_event);
+    }
+#endif
+
+    // 启动接收
+    if (worker_queue_work(&device->rx_start_work) < 0)
+    {
+        // 清理资源
+        uart_storage_free(device);
+        vSemaphoreDelete(device->tx_mutex);
+        vSemaphoreDelete(device->rx_mutex);
+        vSemaphoreDelete(device->tx_space_sem);
+        vSemaphoreDelete(device->rx_data_sem);
+        device->initialized = false;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief 复制到发送环形缓冲区，空间不足时等待发送完成释放空间（调用者持有发送互斥锁）
+ * @param start 本次操作开始的tick
+ * @param timeout 本次操作的总超时
+ * @return 复制的字节数
+ */
+static size_t uart_tx_copy(uart_device_t *device, const uint8_t *data, size_t size, TickType_t start,
+                           TickType_t timeout)
+{
+    size_t copied = 0;
+    TickType_t waited = 0;
+
+    while (copied < size)
+    {
+        uint32_t len;
+        uint8_t *dst = uart_ring_write_reserve_max(&device->tx_ring, size - copied, &len);
+        if (dst == NULL)
+        {
+            // 缓冲区满：确保发送在进行，再等待发送完成
+            device->tx_waiting = true;
+            uart_tx_kick(device);
+            TickType_t now = xTaskGetTickCount();
+            TickType_t elapsed = now - start;
+            if (elapsed >= timeout)
+            {
+                break;
+            }
+            BaseType_t taken = xSemaphoreTake(device->tx_space_sem, timeout - elapsed);
+            waited += xTaskGetTickCount() - now;
+            if (taken != pdTRUE)
+            {
+                break;
+            }
+            continue;
+        }
+
+        memcpy(dst, data + copied, len);
+        uart_ring_write_commit(&device->tx_ring, len);
+        device->tx_committed += len;
+        copied += len;
+    }
+
+#if UART_STATS_ENABLE
+    uart_stat_max(&device->stats.tx_high_water, uart_ring_used(&device->tx_ring));
+    if (waited > 0)
+    {
+        uart_stats_tx_wait(device, waited);
+    }
+#else
+    (void)waited;
+#endif
+
+    return copied;
+}
+
+// 请求排到发送队列尾部，排在此前写入缓冲区的数据之后（调用者持有发送互斥锁）
+static void uart_tx_req_enqueue(uart_device_t *device, uart_tx_req_t *req)
+{
+    req->sent = 0;
+    req->next = NULL;
+    req->result = ESP_OK;
+    req->state = UART_TX_REQ_PENDING;
+
+    taskENTER_CRITICAL();
+    req->mark = device->tx_committed;
+    if (device->tx_req_tail)
+    {
+        device->tx_req_tail->next = req;
+    }
+    else
+    {
+        device->tx_req_head = req;
+    }
+    device->tx_req_tail = req;
+    taskEXIT_CRITICAL();
+
+    uart_tx_kick(device);
+}
+
+/**
+ * @brief 等待请求结束
+ * @param force 超时后仍等待正在DMA发送的请求（请求在调用者栈上，返回前必须离开发送队列）
+ */
+static esp_err_t uart_tx_req_wait_done(uart_device_t *device, uart_tx_req_t *req, TickType_t ticks_to_wait,
+                                       bool force)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while (req->state == UART_TX_REQ_PENDING)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= ticks_to_wait)
+        {
+            if (!force)
+            {
+                return ESP_ERR_TIMEOUT;
+            }
+
+            // 还没开始发送的请求直接撤出队列，正在发送的等DMA结束
+            taskENTER_CRITICAL();
+            if (req->state == UART_TX_REQ_PENDING && device->tx_cur_req != req)
+            {
+                uart_tx_req_unlink(device, req);
+                req->result = ESP_ERR_TIMEOUT;
+                req->state = UART_TX_REQ_DONE;
+            }
+            taskEXIT_CRITICAL();
+            elapsed = 0;
+            ticks_to_wait = 1;
+            start = xTaskGetTickCount();
+        }
+
+        device->tx_waiting = true;
+        uart_tx_kick(device);
+        xSemaphoreTake(device->tx_space_sem, ticks_to_wait - elapsed);
+    }
+
+    return (req->result == ESP_OK) ? ESP_OK : ESP_FAIL;
+}
+
+// 发送数据
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size)
+{
+    if (uart_num >= UART_NUM_MAX || src == NULL || size == 0)
+    {
+        return -1;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized)
+    {
+        return -1;
+    }
+
+    // 获取发送互斥锁
+    if (xSemaphoreTake(device->tx_mutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+    {
+        return -1;
+    }
+
+    // 复制到发送环形缓冲区，空间不足时等待发送完成释放空间（最多1000ms）
+#if UART_STATS_ENABLE
+    bool sampled = uart_stats_tx_mark(device, device->tx_committed + (uint32_t)size);
+#endif
+    size_t bytes_sent = uart_tx_copy(device, (const uint8_t *)src, size, xTaskGetTickCount(), pdMS_TO_TICKS(1000));
+#if UART_STATS_ENABLE
+    uart_stats_tx_short(device, size, bytes_sent, sampled);
+#endif
+
+    xSemaphoreGive(device->tx_mutex);
+
+    // 触发发送处理（如果当前不忙）
+    if (bytes_sent > 0)
+    {
+        uart_tx_kick(device);
+    }
+
+    return (int)bytes_sent;
+}
+
+// 分段发送
+int uart_writev(uart_port_t uart_num, const uart_iovec_t *iov, int iovcnt)
+{
+    if (uart_num >= UART_NUM_MAX || iov == NULL || iovcnt <= 0)
+    {
+        return -1;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized)
+    {
+        return -1;
+    }
+
+    if (xSemaphoreTake(device->tx_mutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+    {
+        return -1;
+    }
+
+    // 长段用栈上的请求直接发送；后面的短段照常写入缓冲区，发送时排在请求之后
+    uart_tx_req_t req;
+    bool req_used = false;
+    size_t total = 0;
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(1000);
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        const uint8_t *base = (const uint8_t *)iov[i].base;
+        size_t len = iov[i].len;
+
+        if (base == NULL || len == 0)
+        {
+            continue;
+        }
+
+        if (len >= UART_TX_ZEROCOPY_MIN)
+        {
+            // 上一个长段发完后才能复用请求
+            if (req_used && uart_tx_req_wait_done(device, &req, timeout, true) != ESP_OK)
+            {
+                break;
+            }
+            uart_tx_req_init(&req, base, (uint32_t)len, NULL, NULL);
+            uart_tx_req_enqueue(device, &req);
+            req_used = true;
+            total += len;
+            continue;
+        }
+
+        size_t copied = uart_tx_copy(device, base, len, start, timeout);
+        total += copied;
+        if (copied < len)
+        {
+            break;
+        }
+    }
+
+    if (total > 0)
+    {
+        uart_tx_kick(device);
+    }
+
+    // 调用者的缓冲区发送完才能返回
+    if (req_used && uart_tx_req_wait_done(device, &req, timeout, true) != ESP_OK)
+    {
+        total -= req.len - req.sent;
+    }
+
+#if UART_STATS_ENABLE
+    size_t requested = 0;
+    for (int i = 0; i < iovcnt; i++)
+    {
+        requested += (iov[i].base != NULL) ? iov[i].len : 0;
+    }
+    uart_stats_tx_short(device, requested, total, false);
+#endif
+
+    xSemaphoreGive(device->tx_mutex);
+
+    return (int)total;
+}
+
+void uart_tx_req_init(uart_tx_req_t *req, const void *data, uint32_t len, uart_tx_done_cb_t cb, void *arg)
+{
+    if (!req)
+    {
+        return;
+    }
+
+    memset(req, 0, sizeof(*req));
+    worker_work_init(&req->work, uart_tx_req_work, req, "UartTxDone");
+    req->data = (const uint8_t *)data;
+    req->len = len;
+    req->cb = cb;
+    req->arg = arg;
+    req->state = UART_TX_REQ_IDLE;
+}
+
+// 异步发送
+esp_err_t uart_write_async(uart_port_t uart_num, uart_tx_req_t *req)
+{
+    if (uart_num >= UART_NUM_MAX || req == NULL || req->data == NULL || req->len == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized || req->state == UART_TX_REQ_PENDING)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 只为确定排队位置持锁，不等待发送
+    if (xSemaphoreTake(device->tx_mutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    uart_tx_req_enqueue(device, req);
+    xSemaphoreGive(device->tx_mutex);
+
+    return ESP_OK;
+}
+
+// 等待异步发送完成
+esp_err_t uart_tx_req_wait(uart_port_t uart_num, uart_tx_req_t *req, TickType_t ticks_to_wait)
+{
+    if (uart_num >= UART_NUM_MAX || req == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (req->state == UART_TX_REQ_IDLE)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return uart_tx_req_wait_done(&uart_devices[uart_num], req, ticks_to_wait, false);
+}
+
+// 读取方取走数据后，缓冲降到低水位时恢复RTS（调用者持有接收互斥锁）
+static void uart_rts_resume(uart_device_t *device)
+{
+    if (device->rts_set == NULL || device->rts_ready)
+    {
+        return;
+    }
+
+    // 与接收中断的撤销互斥
+    taskENTER_CRITICAL();
+    if (device->rts_set != NULL && !device->rts_ready && uart_ring_used(&device->rx_ring) <= device->rts_low)
+    {
+        device->rts_ready = true;
+        device->rts_set((uart_port_t)(device - uart_devices), true);
+    }
+    taskEXIT_CRITICAL();
+}
+
+// 不按分隔符时最多能等到的缓冲字节数：使用RTS流控时到高水位对方就会暂停
+static uint32_t uart_rx_limit(const uart_device_t *device)
+{
+    return (device->rts_set != NULL) ? device->rts_high : device->rx_buffer_size;
+}
+
+// 等待结果
+typedef enum
+{
+    UART_RX_WAIT_DATA,    // 有新数据（或被提前唤醒），重新检查
+    UART_RX_WAIT_CLEARED, // uart_clear丢弃了接收数据，已检查过的位置失效
+    UART_RX_WAIT_TIMEOUT, // 超时
+} uart_rx_wait_t;
+
+/**
+ * @brief 等待接收数据（调用者持有接收互斥锁）
+ * @param have 已检查过的字节数，按分隔符等待时此后的新数据中出现delim才唤醒
+ * @param want 缓冲区中有want字节时唤醒
+ * @param delim 分隔符，-1表示只按字节数唤醒
+ * @param start 本次操作开始的tick
+ * @param timeout 本次操作的总超时
+ */
+static uart_rx_wait_t uart_rx_wait(uart_device_t *device, uint32_t have, uint32_t want, int delim, TickType_t start,
+                                   TickType_t timeout)
+{
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= timeout)
+    {
+        return UART_RX_WAIT_TIMEOUT;
+    }
+
+    // 先登记等待条件再检查一次，登记前到达的数据不会被漏掉
+    device->rx_wait_delim = (int16_t)delim;
+    __atomic_store_n(&device->rx_wait_bytes, want, __ATOMIC_SEQ_CST);
+    uint32_t used = uart_ring_used(&device->rx_ring);
+    BaseType_t got = pdTRUE;
+    if (used < want && (delim < 0 || used <= have) && !device->rx_discard)
+    {
+        got = xSemaphoreTake(device->rx_data_sem, timeout - elapsed);
+    }
+    device->rx_wait_bytes = 0;
+
+    if (device->rx_discard)
+    {
+        device->rx_discard = false;
+        uart_ring_read_discard(&device->rx_ring);
+        uart_rts_resume(device);
+        return UART_RX_WAIT_CLEARED;
+    }
+    return (got == pdTRUE) ? UART_RX_WAIT_DATA : UART_RX_WAIT_TIMEOUT;
+}
+
+// 释放接收互斥锁，持有期间uart_clear请求过丢弃时先丢弃接收数据
+static void uart_rx_unlock(uart_device_t *device)
+{
+    if (device->rx_discard)
+    {
+        device->rx_discard = false;
+        uart_ring_read_discard(&device->rx_ring);
+    }
+    uart_rts_resume(device);
+    xSemaphoreGive(device->rx_mutex);
+}
+
+// 从接收环形缓冲区取出len字节（调用者持有接收互斥锁，且缓冲区中至少有len字节）
+static void uart_rx_copy(uart_device_t *device, uint8_t *dst, uint32_t len)
+{
+    while (len > 0)
+    {
+        uint32_t n;
+        uint8_t *src = uart_ring_read_acquire(&device->rx_ring, &n);
+        if (src == NULL)
+        {
+            break;
+        }
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(dst, src, n);
+        uart_ring_read_release(&device->rx_ring, n);
+        dst += n;
+        len -= n;
+    }
+}
+
+// 接收数据
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    if (uart_num >= UART_NUM_MAX || buf == NULL || length == 0)
+    {
+        return -1;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized)
+    {
+        return -1;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    if (xSemaphoreTake(device->rx_mutex, ticks_to_wait) != pdTRUE)
+    {
+        return 0;
+    }
+
+    // 有数据就返回，缓冲区空时等待
+    uint32_t used;
+    while ((used = uart_ring_used(&device->rx_ring)) == 0)
+    {
+        if (uart_rx_wait(device, 0, 1, -1, start, ticks_to_wait) == UART_RX_WAIT_TIMEOUT)
+        {
+            break;
+        }
+    }
+
+    uint32_t len = (used < length) ? used : length;
+    uart_rx_copy(device, (uint8_t *)buf, len);
+    uart_rx_unlock(device);
+
+    return (int)len;
+}
+
+// 按分隔符接收
+int uart_read_until(uart_port_t uart_num, uint8_t delim, void *buf, uint32_t max, TickType_t ticks_to_wait)
+{
+    if (uart_num >= UART_NUM_MAX || buf == NULL || max == 0)
+    {
+        return -1;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized)
+    {
+        return -1;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    if (xSemaphoreTake(device->rx_mutex, ticks_to_wait) != pdTRUE)
+    {
+        return 0;
+    }
+
+    // 在环形缓冲区中原地查找，已查过的部分不再重复查找；
+    // 中断只在收到分隔符或缓冲满max字节时唤醒，每行只需一次等待。
+    // max超过缓冲区能积累的数据量（使用RTS流控时为高水位）时按能积累的量判断缓冲满
+    uint32_t full = uart_rx_limit(device);
+    if (full > max)
+    {
+        full = max;
+    }
+    uint32_t scanned = 0;
+    int len = 0;
+    while (len == 0)
+    {
+        uint32_t used = uart_ring_used(&device->rx_ring);
+        uint32_t limit = (used < max) ? used : max;
+
+        while (scanned < limit)
+        {
+            uint32_t n;
+            const uint8_t *p = uart_ring_read_peek(&device->rx_ring, scanned, &n);
+            if (p == NULL)
+            {
+                break;
+            }
+            if (n > limit - scanned)
+            {
+                n = limit - scanned;
+            }
+            const uint8_t *hit = memchr(p, delim, n);
+            if (hit != NULL)
+            {
+                len = (int)(scanned + (uint32_t)(hit - p) + 1);
+                break;
+            }
+            scanned += n;
+        }
+
+        if (len == 0 && scanned >= full)
+        {
+            // 缓冲满仍没有分隔符：返回已查找的数据（最多max字节），剩余部分下次读取
+            len = (int)scanned;
+        }
+        if (len != 0)
+        {
+            break;
+        }
+
+        uart_rx_wait_t ret = uart_rx_wait(device, scanned, full, delim, start, ticks_to_wait);
+        if (ret == UART_RX_WAIT_TIMEOUT)
+        {
+            break;
+        }
+        if (ret == UART_RX_WAIT_CLEARED)
+        {
+            scanned = 0;
+        }
+    }
+
+    if (len > 0)
+    {
+        uart_rx_copy(device, (uint8_t *)buf, (uint32_t)len);
+    }
+    uart_rx_unlock(device);
+
+    return len;
+}
+
+// 按行接收
+int uart_readline(uart_port_t uart_num, char *buf, uint32_t max, TickType_t ticks_to_wait)
+{
+    if (buf == NULL || max < 2)
+    {
+        return -1;
+    }
+
+    int len = uart_read_until(uart_num, '\n', buf, max - 1, ticks_to_wait);
+    if (len <= 0)
+    {
+        return -1;
+    }
+
+    // 去掉行尾的"\n"或"\r\n"
+    if (buf[len - 1] == '\n')
+    {
+        len--;
+        if (len > 0 && buf[len - 1] == '\r')
+        {
+            len--;
+        }
+    }
+    buf[len] = '\0';
+
+    return len;
+}
+
+// 等待发送完成
+esp_err_t uart_flush(uart_port_t uart_num)
+{
+    if (uart_num >= UART_NUM_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 等待环形缓冲区为空且发送不忙（发送完成中断通知，超时只是防止错过通知）
+    while (uart_tx_pending(device) || device->tx_busy)
+    {
+        // 如果有剩余数据且发送不忙，触发发送
+        device->tx_waiting = true;
+        uart_tx_kick(device);
+        xSemaphoreTake(device->tx_space_sem, pdMS_TO_TICKS(10));
+    }
+
+    return ESP_OK;
+}
+
+// 清空缓冲区
+esp_err_t uart_clear(uart_port_t uart_num)
+{
+    if (uart_num >= UART_NUM_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 清空发送和接收缓冲区：正在DMA发送的一段不能丢弃，只丢弃其后还没开始发送的数据，
+    // 排队的异步请求以ESP_FAIL结束
+    if (xSemaphoreTake(device->tx_mutex, pdMS_TO_TICKS(1000)) == pdTRUE)
+    {
+        uart_tx_req_t *cancelled = NULL;
+        BaseType_t woken = pdFALSE;
+
+        taskENTER_CRITICAL();
+        if (!device->tx_busy)
+        {
+            cancelled = uart_tx_discard_locked(device);
+            // 两段发送之间被清空：不会再有TC中断，在这里释放RS-485总线
+            uart_rs485_tx_end(device, &woken);
+        }
+        else
+        {
+            device->tx_discard = true;
+        }
+        taskEXIT_CRITICAL();
+        if (woken == pdTRUE)
+        {
+            taskYIELD();
+        }
+
+        while (cancelled)
+        {
+            uart_tx_req_t *next = cancelled->next;
+            cancelled->next = NULL;
+            cancelled->result = ESP_FAIL;
+            cancelled->state = UART_TX_REQ_DONE;
+            if (cancelled->cb)
+            {
+                worker_queue_work(&cancelled->work);
+            }
+            cancelled = next;
+        }
+
+        // 正在发送时由发送完成中断丢弃，期间不能有新的写入
+        TickType_t start = xTaskGetTickCount();
+        while (device->tx_discard && xTaskGetTickCount() - start < pdMS_TO_TICKS(1000))
+        {
+            device->tx_waiting = true;
+            xSemaphoreTake(device->tx_space_sem, pdMS_TO_TICKS(10));
+        }
+        xSemaphoreGive(device->tx_mutex);
+    }
+
+    // 接收缓冲区只能由读取方丢弃：没有读取者时直接丢弃，否则交给读取者（等待中的读取者被唤醒）
+    device->rx_discard = true;
+    if (xSemaphoreTake(device->rx_mutex, 0) == pdTRUE)
+    {
+        uart_rx_unlock(device);
+    }
+    else
+    {
+        xSemaphoreGive(device->rx_data_sem);
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief 按当前波特率选择空闲上报方式（调用者关中断）
+ *
+ * 空闲时间不超过一个字符时间时使用DMA接收的硬件空闲事件（USART在线路空闲一个字符后置位IDLE），
+ * 否则按系统tick计时（向上取整）。
+ */
+static void uart_rx_idle_config(uart_device_t *device)
+{
+    const UART_InitTypeDef *init = &device->hal_uart->Init;
+    uint32_t idle_us = device->rx_evt_idle_us;
+
+    device->rx_evt_idle_ticks = 0;
+    device->rx_evt_idle_hw = false;
+    if (idle_us == 0)
+    {
+        return;
+    }
+
+    // 一个字符：起始位 + 数据位（含校验位）+ 停止位
+    uint32_t bits = 1u + ((init->WordLength == UART_WORDLENGTH_9B) ? 9u : 8u) +
+                    ((init->StopBits == UART_STOPBITS_2) ? 2u : 1u);
+    uint32_t char_us = (uint32_t)(((uint64_t)bits * 1000000u + init->BaudRate - 1u) / init->BaudRate);
+    if (device->rx_dma && idle_us <= char_us)
+    {
+        device->rx_evt_idle_hw = true;
+    }
+    else
+    {
+        device->rx_evt_idle_ticks = (TickType_t)(((uint64_t)idle_us * configTICK_RATE_HZ + 999999u) / 1000000u);
+    }
+}
+
+// 设置接收事件回调
+esp_err_t uart_set_rx_event(uart_port_t uart_num, uint32_t min_bytes, uint32_t idle_timeout_us, uart_event_cb_t cb)
+{
+    if (uart_num >= UART_NUM_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-// UART设备实例数组
-static uart_device_t uart_devices[UART_NUM_MAX] = {0};
+    uart_device_t *device = &uart_devices[uart_num];
 
-// HAL UART句柄映射表（需要用户在具体项目中定义）
-extern UART_HandleTypeDef huart1;
-extern UART_HandleTypeDef huart2;
-extern UART_HandleTypeDef huart3;
+    if (!device->initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (min_bytes > device->rx_buffer_size)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 先关闭事件，修改条件后再打开，中断不会看到一半的配置
+    device->rx_evt_cb = NULL;
+    worker_timer_cancel(&device->rx_idle_timer);
+    device->rx_idle_armed = false;
+    if (cb == NULL)
+    {
+        return ESP_OK;
+    }
+
+    taskENTER_CRITICAL();
+    device->rx_evt_min_bytes = min_bytes;
+    device->rx_evt_idle_us = idle_timeout_us;
+    uart_rx_idle_config(device);
+    device->rx_reported = device->rx_total;
+    device->rx_evt_cb = cb;
+    taskEXIT_CRITICAL();
+
+    return ESP_OK;
+}
 
-// HAL UART句柄映射
-static UART_HandleTypeDef *get_hal_uart_handle(uart_port_t port)
+// 启用模式检测
+esp_err_t uart_enable_pattern_det(uart_port_t uart_num, char pattern_chr)
 {
-    switch (port)
+    if (uart_num >= UART_NUM_MAX)
     {
-    case UART_NUM_0:
-        return &huart1;
-    case UART_NUM_1:
-        return &huart2;
-    case UART_NUM_2:
-        return &huart3;
-    default:
-        return NULL;
+        return ESP_ERR_INVALID_ARG;
     }
+
+    uart_devices[uart_num].rx_pattern = (uint8_t)pattern_chr;
+    return ESP_OK;
 }
 
-// 查找端口号通过HAL句柄
-static uart_port_t find_port_by_hal_handle(UART_HandleTypeDef *huart)
+// 关闭模式检测
+esp_err_t uart_disable_pattern_det(uart_port_t uart_num)
 {
-    for (int i = 0; i < UART_NUM_MAX; i++)
+    if (uart_num >= UART_NUM_MAX)
     {
-        if (uart_devices[i].hal_uart == huart && uart_devices[i].initialized)
-        {
-            return (uart_port_t)i;
-        }
+        return ESP_ERR_INVALID_ARG;
     }
-    return UART_NUM_MAX; // 未找到
+
+    uart_devices[uart_num].rx_pattern = -1;
+    return ESP_OK;
 }
 
-// Worker任务：处理发送数据（非阻塞版本）
-static void uart_tx_worker_task(void *arg)
+// 设置流控
+esp_err_t uart_set_flow_ctrl(uart_port_t uart_num, const uart_flow_ctrl_t *cfg)
 {
-    uart_port_t port = (uart_port_t)(uintptr_t)arg;
-    uart_device_t *device = &uart_devices[port];
-    size_t bytes_to_send;
+    if (uart_num >= UART_NUM_MAX || cfg == NULL || cfg->flow_ctrl > UART_HW_FLOWCTRL_CTS_RTS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    // 检查是否有数据需要发送且当前不忙
-    if (device->tx_busy || !device->initialized)
+    uart_device_t *device = &uart_devices[uart_num];
+
+    if (!device->initialized)
     {
-        return; // 发送忙或未初始化，直接返回
+        return ESP_ERR_INVALID_STATE;
     }
 
-    // 从发送流缓冲区获取数据（非阻塞）
-    bytes_to_send = xStreamBufferReceive(device->tx_stream, device->tx_temp_buffer,
-                                         sizeof(device->tx_temp_buffer), 0);
+    bool rts = (cfg->flow_ctrl & UART_HW_FLOWCTRL_RTS) != 0;
+    bool cts = (cfg->flow_ctrl & UART_HW_FLOWCTRL_CTS) != 0;
+    uint32_t high = (cfg->rx_high != 0) ? cfg->rx_high : device->rx_buffer_size * 3 / 4;
+    uint32_t low = (cfg->rx_low != 0) ? cfg->rx_low : device->rx_buffer_size / 4;
+    if (rts && (cfg->set_rts == NULL || high == 0 || high > device->rx_buffer_size || low >= high))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    if (bytes_to_send > 0)
+    UART_HandleTypeDef *huart = device->hal_uart;
+    bool cts_on = READ_BIT(huart->Instance->CR3, USART_CR3_CTSE) != 0;
+    if (cts != cts_on && device->tx_busy)
     {
-        device->tx_busy = true;
+        // 切换CTS要关闭USART，正在发送的数据会被打断
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // RTS：先关闭，撤销状态下关闭时恢复RTS，避免对方一直暂停
+    taskENTER_CRITICAL();
+    uart_rts_set_t old = device->rts_set;
+    bool old_ready = device->rts_ready;
+    device->rts_set = NULL;
+    device->rts_ready = true;
+    taskEXIT_CRITICAL();
+    if (old != NULL && !old_ready)
+    {
+        old(uart_num, true);
+    }
+
+    if (rts)
+    {
+        taskENTER_CRITICAL();
+        device->rts_high = high;
+        device->rts_low = low;
+        device->rts_ready = uart_ring_used(&device->rx_ring) < high;
+        device->rts_set = cfg->set_rts;
+        cfg->set_rts(uart_num, device->rts_ready);
+        taskEXIT_CRITICAL();
+    }
 
-        // 使用DMA或中断模式发送
-        if (device->hal_uart->hdmatx != NULL)
+    // CTS：硬件在CTS撤销时暂停发送，DMA请求随之暂停，不需要驱动干预
+    if (cts != cts_on)
+    {
+        taskENTER_CRITICAL();
+        CLEAR_BIT(huart->Instance->CR1, USART_CR1_UE);
+        if (cts)
         {
-            // DMA模式发送
-            HAL_UART_Transmit_DMA(device->hal_uart, device->tx_temp_buffer, bytes_to_send);
+            SET_BIT(huart->Instance->CR3, USART_CR3_CTSE);
         }
         else
         {
-            // 中断模式发送
-            HAL_UART_Transmit_IT(device->hal_uart, device->tx_temp_buffer, bytes_to_send);
+            CLEAR_BIT(huart->Instance->CR3, USART_CR3_CTSE);
         }
-        // 注意：发送完成后会在回调函数中清除tx_busy标志并继续处理下一批数据
+        SET_BIT(huart->Instance->CR1, USART_CR1_UE);
+        taskEXIT_CRITICAL();
     }
+
+    // RTSE保持关闭：循环DMA总会取空数据寄存器，硬件RTS不会撤销
+    huart->Init.HwFlowCtl = cts ? UART_HWCONTROL_CTS : UART_HWCONTROL_NONE;
+
+    return ESP_OK;
 }
 
-// 启动接收的Worker任务
-static void uart_rx_start_worker_task(void *arg)
+// 设置RS-485半双工模式
+esp_err_t uart_set_rs485(uart_port_t uart_num, const uart_rs485_t *cfg)
 {
-    uart_port_t port = (uart_port_t)(uintptr_t)arg;
-    uart_device_t *device = &uart_devices[port];
+    if (uart_num >= UART_NUM_MAX || cfg == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uart_device_t *device = &uart_devices[uart_num];
 
     if (!device->initialized)
     {
-        return;
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (cfg->enable && device->mode == UART_XFER_POLL)
+    {
+        // 轮询接收不能及时取走回波，也没有TC中断释放总线
+        return ESP_ERR_NOT_SUPPORTED;
     }
 
-    // 启动DMA接收或中断接收
-    if (device->hal_uart->hdmarx != NULL)
+    UART_HandleTypeDef *huart = device->hal_uart;
+    bool hw_de = false;
+#ifdef USART_CR3_DEM
+    hw_de = cfg->enable && cfg->set_de == NULL;
+#endif
+
+    taskENTER_CRITICAL();
+    if (device->tx_busy)
     {
-        HAL_UART_Receive_DMA(device->hal_uart, device->rx_temp_buffer, sizeof(device->rx_temp_buffer));
+        taskEXIT_CRITICAL();
+        return ESP_ERR_INVALID_STATE;
     }
-    else
+    if (device->rs485_tx && device->rs485_de != NULL)
     {
-        HAL_UART_Receive_IT(device->hal_uart, device->rx_temp_buffer, 1);
+        // 两段发送之间切换：释放原来的DE
+        device->rs485_de(uart_num, false);
     }
-}
-
-// HAL回调函数：发送完成
-static void uart_tx_complete_callback(UART_HandleTypeDef *huart)
-{
-    // 找到对应的UART设备
-    uart_port_t port = find_port_by_hal_handle(huart);
-    if (port < UART_NUM_MAX)
+    device->rs485_tx = false;
+    device->rs485 = cfg->enable;
+    device->rs485_echo = cfg->enable && cfg->echo_suppress;
+    device->rs485_de = cfg->enable ? cfg->set_de : NULL;
+    if (device->rs485_de != NULL)
     {
-        uart_device_t *device = &uart_devices[port];
-
-        // 清除发送忙标志
-        device->tx_busy = false;
+        device->rs485_de(uart_num, false);
+    }
 
-        // 检查是否还有数据需要发送，如果有则触发新的发送任务
-        if (xStreamBufferBytesAvailable(device->tx_stream) > 0)
+#ifdef USART_CR3_DEM
+    // 硬件DE：USART在发送前后自动控制DE引脚（高电平有效），DEM只能在USART关闭时修改
+    if (hw_de != (READ_BIT(huart->Instance->CR3, USART_CR3_DEM) != 0))
+    {
+        CLEAR_BIT(huart->Instance->CR1, USART_CR1_UE);
+        if (hw_de)
         {
-            worker_queue_item_t tx_item = {
-                .cb = uart_tx_worker_task,
-                .arg = (void *)(uintptr_t)port,
-                .flags = WORKER_FLAG_NONE,
-                .name = "UartTxContinue"};
-            worker_send(&tx_item);
+            CLEAR_BIT(huart->Instance->CR3, USART_CR3_DEP);
+            SET_BIT(huart->Instance->CR3, USART_CR3_DEM);
         }
+        else
+        {
+            CLEAR_BIT(huart->Instance->CR3, USART_CR3_DEM);
+        }
+        SET_BIT(huart->Instance->CR1, USART_CR1_UE);
     }
+#else
+    (void)huart;
+    (void)hw_de;
+#endif
+    taskEXIT_CRITICAL();
+
+    return ESP_OK;
 }
 
-// HAL回调函数：接收完成
-static void uart_rx_complete_callback(UART_HandleTypeDef *huart)
+/**
+ * @brief 占用发送并等待发送缓冲区发完（返回时持有发送互斥锁，没有写入者）
+ * @return true:已发完 false:超时
+ */
+static bool uart_tx_drain_lock(uart_device_t *device, TickType_t ticks_to_wait)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    TickType_t start = xTaskGetTickCount();
 
-    // 找到对应的UART设备
-    uart_port_t port = find_port_by_hal_handle(huart);
-    if (port < UART_NUM_MAX)
+    if (xSemaphoreTake(device->tx_mutex, ticks_to_wait) != pdTRUE)
     {
-        uart_device_t *device = &uart_devices[port];
-
-        if (device->hal_uart->hdmarx != NULL)
-        {
-            // DMA模式：将整个缓冲区的数据写入流缓冲区
-            size_t received_bytes = sizeof(device->rx_temp_buffer) - __HAL_DMA_GET_COUNTER(huart->hdmarx);
-            if (received_bytes > 0)
-            {
-                xStreamBufferSendFromISR(device->rx_stream, device->rx_temp_buffer,
-                                         received_bytes, &xHigherPriorityTaskWoken);
-            }
-
-            // 重新启动DMA接收
-            HAL_UART_Receive_DMA(huart, device->rx_temp_buffer, sizeof(device->rx_temp_buffer));
-        }
-        else
+        return false;
+    }
+    while (uart_tx_pending(device) || device->tx_busy)
+    {
+        if (xTaskGetTickCount() - start >= ticks_to_wait)
         {
-            // 中断模式：单字节接收
-            xStreamBufferSendFromISR(device->rx_stream, device->rx_temp_buffer, 1, &xHigherPriorityTaskWoken);
-
-            // 继续接收下一个字节
-            HAL_UART_Receive_IT(huart, device->rx_temp_buffer, 1);
+            xSemaphoreGive(device->tx_mutex);
+            return false;
         }
+        device->tx_waiting = true;
+        uart_tx_kick(device);
+        xSemaphoreTake(device->tx_space_sem, pdMS_TO_TICKS(10));
     }
-
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    return true;
 }
 
-// HAL回调函数：接收半完成
-static void uart_rx_half_complete_callback(UART_HandleTypeDef *huart)
+/**
+ * @brief 停止接收，已收到的数据先写入接收环形缓冲区（任务中调用）
+ *
+ * 先关闭DMA接收请求，DMA写位置不再变化，取走已写入的数据后再中止接收。
+ */
+static void uart_rx_stop(uart_device_t *device)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    UART_HandleTypeDef *huart = device->hal_uart;
+    BaseType_t woken = pdFALSE;
 
-    // 找到对应的UART设备
-    uart_port_t port = find_port_by_hal_handle(huart);
-    if (port < UART_NUM_MAX)
+    if (device->mode == UART_XFER_POLL)
     {
-        uart_device_t *device = &uart_devices[port];
+        return;
+    }
 
-        // DMA半完成：处理前半部分数据
-        size_t half_size = sizeof(device->rx_temp_buffer) / 2;
-        xStreamBufferSendFromISR(device->rx_stream, device->rx_temp_buffer,
-                                 half_size, &xHigherPriorityTaskWoken);
+    taskENTER_CRITICAL();
+    if (device->rx_dma)
+    {
+        CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+        uart_rx_dma_sync(device, &woken);
     }
+    taskEXIT_CRITICAL();
 
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    HAL_UART_AbortReceive(huart);
+    if (woken == pdTRUE)
+    {
+        taskYIELD();
+    }
 }
 
-// HAL回调函数：错误处理
-static void uart_error_callback(UART_HandleTypeDef *huart)
+// 按huart->Init重新配置USART（保持单线半双工模式）
+static HAL_StatusTypeDef uart_reconfig(UART_HandleTypeDef *huart)
 {
-    // 找到对应的UART设备
-    uart_port_t port = find_port_by_hal_handle(huart);
-    if (port < UART_NUM_MAX)
+    if (READ_BIT(huart->Instance->CR3, USART_CR3_HDSEL))
     {
-        uart_device_t *device = &uart_devices[port];
-
-        // 清除发送忙标志
-        device->tx_busy = false;
-
-        // 重新启动接收 - 通过Worker任务处理
-        worker_queue_item_t rx_item = {
-            .cb = uart_rx_start_worker_task,
-            .arg = (void *)(uintptr_t)port,
-            .flags = WORKER_FLAG_HIGH_PRIO,
-            .name = "UartRxRestart"};
-
-        worker_send(&rx_item);
+        return HAL_HalfDuplex_Init(huart);
     }
+    return HAL_UART_Init(huart);
 }
 
-// 初始化UART
-esp_err_t uart_async_init(uart_port_t port, uint32_t size)
+// 设置波特率
+esp_err_t uart_set_baudrate(uart_port_t uart_num, uint32_t baud_rate)
 {
-    if (port >= UART_NUM_MAX)
+    if (uart_num >= UART_NUM_MAX || baud_rate == 0)
     {
         return ESP_ERR_INVALID_ARG;
     }
 
-    uart_device_t *device = &uart_devices[port];
+    uart_device_t *device = &uart_devices[uart_num];
 
-    if (device->initialized)
+    if (!device->initialized)
     {
         return ESP_ERR_INVALID_STATE;
     }
 
-    // 获取HAL UART句柄
-    device->hal_uart = get_hal_uart_handle(port);
-    if (device->hal_uart == NULL)
+    if (!uart_tx_drain_lock(device, pdMS_TO_TICKS(1000)))
     {
-        return ESP_ERR_NOT_FOUND;
+        return ESP_ERR_TIMEOUT;
     }
 
-    // 创建流缓冲区
-    device->tx_buffer_size = size;
-    device->rx_buffer_size = size;
-
-    device->tx_stream = xStreamBufferCreate(size, 1);
-    device->rx_stream = xStreamBufferCreate(size, 1);
-
-    if (device->tx_stream == NULL || device->rx_stream == NULL)
+    // BRR由HAL按当前的PCLK计算，时钟切换后以原波特率调用即可重新计算
+    uart_rx_stop(device);
+    UART_HandleTypeDef *huart = device->hal_uart;
+    uint32_t old = huart->Init.BaudRate;
+    huart->Init.BaudRate = baud_rate;
+    HAL_StatusTypeDef ret = uart_reconfig(huart);
+    if (ret != HAL_OK)
     {
-        // 清理已创建的资源
-        if (device->tx_stream)
-            vStreamBufferDelete(device->tx_stream);
-        if (device->rx_stream)
-            vStreamBufferDelete(device->rx_stream);
-        return ESP_ERR_NO_MEM;
+        huart->Init.BaudRate = old;
+        uart_reconfig(huart);
     }
+    taskENTER_CRITICAL();
+    uart_rx_idle_config(device);
+    taskEXIT_CRITICAL();
+    uart_rx_restart(device);
 
-    // 创建互斥锁
-    device->tx_mutex = xSemaphoreCreateMutex();
-    device->rx_mutex = xSemaphoreCreateMutex();
+    xSemaphoreGive(device->tx_mutex);
+    return (ret == HAL_OK) ? ESP_OK : ESP_FAIL;
+}
 
-    if (device->tx_mutex == NULL || device->rx_mutex == NULL)
+// 获取波特率
+esp_err_t uart_get_baudrate(uart_port_t uart_num, uint32_t *baud_rate)
+{
+    if (uart_num >= UART_NUM_MAX || baud_rate == NULL)
     {
-        // 清理资源
-        vStreamBufferDelete(device->tx_stream);
-        vStreamBufferDelete(device->rx_stream);
-        if (device->tx_mutex)
-            vSemaphoreDelete(device->tx_mutex);
-        if (device->rx_mutex)
-            vSemaphoreDelete(device->rx_mutex);
-        return ESP_ERR_NO_MEM;
+        return ESP_ERR_INVALID_ARG;
     }
 
-    device->tx_busy = false;
-    device->initialized = true;
-
-#if (USE_HAL_UART_REGISTER_CALLBACKS == 1)
-    // 注册HAL回调函数
-    HAL_UART_RegisterCallback(device->hal_uart, HAL_UART_TX_COMPLETE_CB_ID, uart_tx_complete_callback);
-    HAL_UART_RegisterCallback(device->hal_uart, HAL_UART_RX_COMPLETE_CB_ID, uart_rx_complete_callback);
-    HAL_UART_RegisterCallback(device->hal_uart, HAL_UART_RX_HALFCOMPLETE_CB_ID, uart_rx_half_complete_callback);
-    HAL_UART_RegisterCallback(device->hal_uart, HAL_UART_ERROR_CB_ID, uart_error_callback);
-#endif
-
-    // 启动接收
-    worker_queue_item_t rx_item = {
-        .cb = uart_rx_start_worker_task,
-        .arg = (void *)(uintptr_t)port,
-        .flags = WORKER_FLAG_NONE,
-        .name = "UartRxStart"};
+    uart_device_t *device = &uart_devices[uart_num];
 
-    if (worker_send(&rx_item) != 0)
+    if (!device->initialized)
     {
-        // 清理资源
-        vStreamBufferDelete(device->tx_stream);
-        vStreamBufferDelete(device->rx_stream);
-        vSemaphoreDelete(device->tx_mutex);
-        vSemaphoreDelete(device->rx_mutex);
-        device->initialized = false;
-        return ESP_ERR_NO_MEM;
+        return ESP_ERR_INVALID_STATE;
     }
 
+    *baud_rate = device->hal_uart->Init.BaudRate;
     return ESP_OK;
 }
 
-// 发送数据
-int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size)
+// 自动波特率检测
+esp_err_t uart_detect_baudrate(uart_port_t uart_num, uart_abr_mode_t mode, TickType_t ticks_to_wait,
+                               uint32_t *baud_rate)
 {
-    if (uart_num >= UART_NUM_MAX || src == NULL || size == 0)
+    if (uart_num >= UART_NUM_MAX || baud_rate == NULL || mode > UART_ABR_0X55)
     {
-        return -1;
+        return ESP_ERR_INVALID_ARG;
     }
 
     uart_device_t *device = &uart_devices[uart_num];
 
     if (!device->initialized)
     {
-        return -1;
+        return ESP_ERR_INVALID_STATE;
     }
 
-    // 获取发送互斥锁
-    if (xSemaphoreTake(device->tx_mutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+#ifdef USART_CR2_ABREN
+    static const uint32_t abr_mode[] = {
+        UART_ADVFEATURE_AUTOBAUDRATE_ONSTARTBIT,
+        UART_ADVFEATURE_AUTOBAUDRATE_ONFALLINGEDGE,
+        UART_ADVFEATURE_AUTOBAUDRATE_ON0X7FFRAME,
+        UART_ADVFEATURE_AUTOBAUDRATE_ON0X55FRAME,
+    };
+    UART_HandleTypeDef *huart = device->hal_uart;
+    TickType_t start = xTaskGetTickCount();
+
+    if (!uart_tx_drain_lock(device, ticks_to_wait))
     {
-        return -1;
+        return ESP_ERR_TIMEOUT;
     }
 
-    // 发送数据到流缓冲区
-    size_t bytes_sent = xStreamBufferSend(device->tx_stream, src, size, pdMS_TO_TICKS(1000));
-
-    xSemaphoreGive(device->tx_mutex);
+    // 检测期间停止接收，ABREN和ABRMOD只能在USART关闭时修改
+    uart_rx_stop(device);
+    uint32_t brr = huart->Instance->BRR;
+    taskENTER_CRITICAL();
+    CLEAR_BIT(huart->Instance->CR1, USART_CR1_UE);
+    MODIFY_REG(huart->Instance->CR2, USART_CR2_ABRMODE, abr_mode[mode]);
+    SET_BIT(huart->Instance->CR2, USART_CR2_ABREN);
+    SET_BIT(huart->Instance->CR1, USART_CR1_UE);
+    taskEXIT_CRITICAL();
+
+    // 同步字符只来一次，按tick查询即可
+    esp_err_t err = ESP_ERR_TIMEOUT;
+    while (xTaskGetTickCount() - start < ticks_to_wait)
+    {
+        if (__HAL_UART_GET_FLAG(huart, UART_FLAG_ABRE))
+        {
+            err = ESP_FAIL;
+            break;
+        }
+        if (__HAL_UART_GET_FLAG(huart, UART_FLAG_ABRF))
+        {
+            err = ESP_OK;
+            break;
+        }
+        vTaskDelay(1);
+    }
 
-    // 触发发送处理（如果当前不忙）
-    if (bytes_sent > 0 && !device->tx_busy)
+    // 检测结果留在BRR中：16倍过采样时BRR与波特率成反比，按比例换算，不需要知道USART时钟
+    uint32_t new_brr = huart->Instance->BRR;
+    taskENTER_CRITICAL();
+    CLEAR_BIT(huart->Instance->CR1, USART_CR1_UE);
+    CLEAR_BIT(huart->Instance->CR2, USART_CR2_ABREN);
+    if (err != ESP_OK)
+    {
+        huart->Instance->BRR = brr;
+    }
+    SET_BIT(huart->Instance->CR1, USART_CR1_UE);
+    taskEXIT_CRITICAL();
+    if (err == ESP_OK && new_brr != 0)
     {
-        worker_queue_item_t tx_item = {
-            .cb = uart_tx_worker_task,
-            .arg = (void *)(uintptr_t)uart_num,
-            .flags = WORKER_FLAG_NONE,
-            .name = "UartTx"};
-        worker_send(&tx_item);
+        huart->Init.BaudRate = (uint32_t)(((uint64_t)huart->Init.BaudRate * brr + new_brr / 2) / new_brr);
+        *baud_rate = huart->Init.BaudRate;
+        taskENTER_CRITICAL();
+        uart_rx_idle_config(device);
+        taskEXIT_CRITICAL();
     }
+    uart_rx_restart(device);
 
-    return (int)bytes_sent;
+    xSemaphoreGive(device->tx_mutex);
+    return err;
+#else
+    // F1/F4的USART没有自动波特率检测
+    (void)mode;
+    (void)ticks_to_wait;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
 }
 
-// 接收数据
-int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
+// 获取接收缓冲区数据长度
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
 {
-    if (uart_num >= UART_NUM_MAX || buf == NULL || length == 0)
+    if (uart_num >= UART_NUM_MAX || size == NULL)
     {
-        return -1;
+        return ESP_ERR_INVALID_ARG;
     }
 
     uart_device_t *device = &uart_devices[uart_num];
 
     if (!device->initialized)
     {
-        return -1;
+        return ESP_ERR_INVALID_STATE;
     }
 
-    // 从接收流缓冲区读取数据
-    size_t bytes_read = xStreamBufferReceive(device->rx_stream, buf, length, ticks_to_wait);
-
-    return (int)bytes_read;
+    *size = uart_ring_used(&device->rx_ring);
+    return ESP_OK;
 }
 
-// 等待发送完成
-esp_err_t uart_flush(uart_port_t uart_num)
+// 获取发送缓冲区空闲空间
+esp_err_t uart_get_tx_buffer_free_size(uart_port_t uart_num, size_t *size)
 {
-    if (uart_num >= UART_NUM_MAX)
+    if (uart_num >= UART_NUM_MAX || size == NULL)
     {
         return ESP_ERR_INVALID_ARG;
     }
@@ -388,30 +2558,16 @@ esp_err_t uart_flush(uart_port_t uart_num)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // 等待流缓冲区为空且发送不忙
-    while (xStreamBufferBytesAvailable(device->tx_stream) > 0 || device->tx_busy)
-    {
-        vTaskDelay(pdMS_TO_TICKS(1));
-
-        // 如果有剩余数据且发送不忙，触发发送
-        if (xStreamBufferBytesAvailable(device->tx_stream) > 0 && !device->tx_busy)
-        {
-            worker_queue_item_t tx_item = {
-                .cb = uart_tx_worker_task,
-                .arg = (void *)(uintptr_t)uart_num,
-                .flags = WORKER_FLAG_NONE,
-                .name = "UartTxFlush"};
-            worker_send(&tx_item);
-        }
-    }
-
+    // 空闲空间总量（回绕时单次能写入的连续空间可能更小，uart_write_bytes会分段写入）
+    uint32_t used = uart_ring_used(&device->tx_ring);
+    *size = (used + 1 < device->tx_ring.size) ? device->tx_ring.size - used - 1 : 0;
     return ESP_OK;
 }
 
-// 清空缓冲区
-esp_err_t uart_clear(uart_port_t uart_num)
+// 获取端口统计
+esp_err_t uart_get_stats(uart_port_t uart_num, uart_stats_t *stats)
 {
-    if (uart_num >= UART_NUM_MAX)
+    if (uart_num >= UART_NUM_MAX || stats == NULL)
     {
         return ESP_ERR_INVALID_ARG;
     }
@@ -423,17 +2579,20 @@ esp_err_t uart_clear(uart_port_t uart_num)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // 清空发送和接收缓冲区
-    xStreamBufferReset(device->tx_stream);
-    xStreamBufferReset(device->rx_stream);
-
+#if UART_STATS_ENABLE
+    taskENTER_CRITICAL();
+    *stats = device->stats;
+    taskEXIT_CRITICAL();
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
     return ESP_OK;
 }
 
-// 获取接收缓冲区数据长度
-esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
+// 清零端口统计
+esp_err_t uart_reset_stats(uart_port_t uart_num)
 {
-    if (uart_num >= UART_NUM_MAX || size == NULL)
+    if (uart_num >= UART_NUM_MAX)
     {
         return ESP_ERR_INVALID_ARG;
     }
@@ -445,32 +2604,116 @@ esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
         return ESP_ERR_INVALID_STATE;
     }
 
-    *size = xStreamBufferBytesAvailable(device->rx_stream);
+#if UART_STATS_ENABLE
+    taskENTER_CRITICAL();
+    memset(&device->stats, 0, sizeof(device->stats));
+    taskEXIT_CRITICAL();
+#endif
     return ESP_OK;
 }
 
-// 获取发送缓冲区空闲空间
-esp_err_t uart_get_tx_buffer_free_size(uart_port_t uart_num, size_t *size)
+void uart_print_stats(uart_port_t uart_num)
 {
-    if (uart_num >= UART_NUM_MAX || size == NULL)
+    uart_stats_t st;
+
+    if (uart_get_stats(uart_num, &st) != ESP_OK)
     {
-        return ESP_ERR_INVALID_ARG;
+        printf("UART%d not initialized\n", uart_num);
+        return;
     }
 
-    uart_device_t *device = &uart_devices[uart_num];
+    const uart_device_t *device = &uart_devices[uart_num];
+
+    printf("=== UART%d Stats ===\n", uart_num);
+    printf("TX: %lu bytes, %lu xfers, short writes: %lu (%lu bytes)\n",
+           (unsigned long)st.tx_bytes,
+           (unsigned long)st.tx_xfers,
+           (unsigned long)st.tx_short_writes,
+           (unsigned long)st.tx_short_bytes);
+    printf("RX: %lu bytes, %lu events, dropped: %lu, rts stalls: %lu, echo: %lu\n",
+           (unsigned long)st.rx_bytes,
+           (unsigned long)st.rx_events,
+           (unsigned long)st.rx_dropped,
+           (unsigned long)st.rts_stalls,
+           (unsigned long)st.rx_echo);
+    printf("Errors: overrun %lu, framing %lu, noise %lu, parity %lu, dma %lu\n",
+           (unsigned long)st.overrun_errors,
+           (unsigned long)st.framing_errors,
+           (unsigned long)st.noise_errors,
+           (unsigned long)st.parity_errors,
+           (unsigned long)st.dma_errors);
+    printf("Buffers: tx high water %lu/%lu, rx high water %lu/%lu\n",
+           (unsigned long)st.tx_high_water,
+           (unsigned long)device->tx_buffer_size,
+           (unsigned long)st.rx_high_water,
+           (unsigned long)device->rx_buffer_size);
+    printf("Writer waits: %lu, total %lu ms, max %lu ms\n",
+           (unsigned long)st.tx_wait_count,
+           (unsigned long)st.tx_wait_ms,
+           (unsigned long)st.tx_wait_max_ms);
+    printf("TX latency (max %lu us):\n", (unsigned long)st.tx_latency_max_us);
+    for (uint32_t i = 0, limit = 64; i < UART_STATS_LATENCY_BUCKETS; i++, limit <<= 2)
+    {
+        if (i < UART_STATS_LATENCY_BUCKETS - 1)
+        {
+            printf("  < %7lu us: %lu\n", (unsigned long)limit, (unsigned long)st.tx_latency[i]);
+        }
+        else
+        {
+            printf("  >=%7lu us: %lu\n", (unsigned long)(limit >> 2), (unsigned long)st.tx_latency[i]);
+        }
+    }
+}
 
-    if (!device->initialized)
+#if UART_SHELL_CMD
+// shell命令：uart [port] [reset]，不带参数时打印所有已初始化的端口
+static int32_t uart_shell_cmd(int32_t argc, char **argv)
+{
+    if (argc < 2)
     {
-        return ESP_ERR_INVALID_STATE;
+        for (int i = 0; i < UART_NUM_MAX; i++)
+        {
+            if (uart_devices[i].initialized)
+            {
+                uart_print_stats((uart_port_t)i);
+            }
+        }
+        return 0;
     }
 
-    *size = xStreamBufferSpacesAvailable(device->tx_stream);
-    return ESP_OK;
+    int port = atoi(argv[1]);
+    if (port < 0 || port >= UART_NUM_MAX || !uart_devices[port].initialized)
+    {
+        printf("usage: uart [port] [reset]\n");
+        return -1;
+    }
+
+    if (argc >= 3 && strcmp(argv[2], "reset") == 0)
+    {
+        uart_reset_stats((uart_port_t)port);
+        return 0;
+    }
+
+    uart_print_stats((uart_port_t)port);
+    return 0;
+}
+
+// 注册shell命令（第一个端口初始化时）
+static void uart_shell_register(void)
+{
+    static bool registered = false;
+
+    if (!registered)
+    {
+        registered = true;
+        lwshell_register_cmd("uart", uart_shell_cmd, "UART statistics: uart [port] [reset]");
+    }
 }
+#endif
 
 int uart3_init(void *arg)
 {
-    return uart_async_init(UART_NUM_2, 1024);
+    return uart_async_init(UART_NUM_2, 0);
 }
 #include "stdlib.h"
 #include "log.h"
@@ -5,7 +5,9 @@
  * 本示例展示了如何使用类似ESP32的UART接口在STM32上实现异步串口通信
  */
 
+#include "hal.h"
 #include "uart.h"
+#include "uart_frame.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include <stdio.h>
@@ -230,22 +232,11 @@ void uart_command_task(void *pvParameters)
 
     while (1)
     {
-        // 接收命令
-        received_bytes = uart_read_bytes(UART_NUM_0, rx_buffer, sizeof(rx_buffer) - 1, portMAX_DELAY);
+        // 接收一行命令（已去掉行尾），整行到达前不会被唤醒
+        received_bytes = uart_readline(UART_NUM_0, rx_buffer, sizeof(rx_buffer), portMAX_DELAY);
 
-        if (received_bytes > 0)
+        if (received_bytes >= 0)
         {
-            rx_buffer[received_bytes] = '\0';
-
-            // 去除换行符
-            char *newline = strchr(rx_buffer, '\n');
-            if (newline)
-                *newline = '\0';
-
-            char *carriage = strchr(rx_buffer, '\r');
-            if (carriage)
-                *carriage = '\0';
-
             // 解析命令和参数
             cmd = strtok(rx_buffer, " ");
             args = strtok(NULL, "");
@@ -320,4 +311,350 @@ esp_err_t uart_advanced_example_init(void)
     }
 
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+// =============================================================================
+// 接收压力测试：TX与RX短接（回环），以伪随机序列验证逐字节一致
+// =============================================================================
+
+typedef struct
+{
+    uart_port_t port;
+    uint32_t total;
+    uint32_t seed;
+    volatile bool done;
+} uart_stress_ctx_t;
+
+// xorshift32伪随机序列，收发两端用相同种子生成
+static uint8_t uart_stress_next(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (uint8_t)x;
+}
+
+// 发送任务：随机长度分段写入，段间随机停顿制造线路空闲
+static void uart_stress_tx_task(void *pvParameters)
+{
+    uart_stress_ctx_t *ctx = (uart_stress_ctx_t *)pvParameters;
+    uint32_t data_state = ctx->seed;
+    uint32_t len_state = ctx->seed ^ 0x5A5A5A5A;
+    uint8_t chunk[200];
+    uint32_t sent = 0;
+
+    while (sent < ctx->total)
+    {
+        uint32_t len = 1 + uart_stress_next(&len_state) % sizeof(chunk);
+        if (len > ctx->total - sent)
+        {
+            len = ctx->total - sent;
+        }
+        for (uint32_t i = 0; i < len; i++)
+        {
+            chunk[i] = uart_stress_next(&data_state);
+        }
+
+        uint32_t off = 0;
+        while (off < len)
+        {
+            int ret = uart_write_bytes(ctx->port, chunk + off, len - off);
+            if (ret > 0)
+            {
+                off += (uint32_t)ret;
+            }
+            else if (ret < 0)
+            {
+                ctx->done = true;
+                vTaskDelete(NULL);
+            }
+        }
+        sent += len;
+
+        if ((uart_stress_next(&len_state) & 0x0F) == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+
+    ctx->done = true;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 接收压力测试（需把port的TX和RX短接）
+ *
+ * 发送total字节伪随机数据并逐字节校验接收结果，用于验证921600~2Mbaud下
+ * 循环DMA接收没有丢失、重复或乱序。
+ *
+ * @param port 串口号（已通过uart_async_init初始化）
+ * @param total 测试字节数
+ * @param seed 随机种子（非0）
+ * @return ESP_OK:全部一致 ESP_FAIL:数据不一致 ESP_ERR_TIMEOUT:接收超时（丢数据）
+ */
+esp_err_t uart_rx_stress_test(uart_port_t port, uint32_t total, uint32_t seed)
+{
+    static uart_stress_ctx_t ctx;
+    uint32_t expect_state = seed ? seed : 1;
+    uint8_t rx_buffer[128];
+    uint32_t received = 0;
+    esp_err_t ret = ESP_OK;
+
+    ctx.port = port;
+    ctx.total = total;
+    ctx.seed = expect_state;
+    ctx.done = false;
+
+    uart_clear(port);
+    TickType_t start = xTaskGetTickCount();
+
+    if (xTaskCreate(uart_stress_tx_task, "UART_STRESS", 1024, &ctx, 5, NULL) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    while (received < total)
+    {
+        int len = uart_read_bytes(port, rx_buffer, sizeof(rx_buffer), pdMS_TO_TICKS(500));
+        if (len <= 0)
+        {
+            printf("UART%d 压力测试超时: 收到 %lu/%lu 字节\n", port, (unsigned long)received, (unsigned long)total);
+            ret = ESP_ERR_TIMEOUT;
+            break;
+        }
+
+        for (int i = 0; i < len; i++)
+        {
+            if (rx_buffer[i] != uart_stress_next(&expect_state))
+            {
+                printf("UART%d 压力测试失败: 第 %lu 字节不一致\n", port, (unsigned long)(received + i));
+                ret = ESP_FAIL;
+                break;
+            }
+        }
+        if (ret != ESP_OK)
+        {
+            break;
+        }
+        received += (uint32_t)len;
+    }
+
+    // 等待发送任务结束后再返回（ctx为静态变量，可被下一次测试复用）
+    while (!ctx.done)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    if (ret == ESP_OK)
+    {
+        uint32_t ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+        printf("UART%d 压力测试通过: %lu 字节, %lu ms\n", port, (unsigned long)total, (unsigned long)ms);
+    }
+
+    return ret;
+}
+
+// 分段发送示例：帧头、负载、校验和分开存放，一次写入，线路上连续
+static uint8_t uart_packet_checksum(const uint8_t *data, uint32_t len)
+{
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        sum += data[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief 发送一帧：[0xAA len_lo len_hi] + payload + [sum]
+ *
+ * 负载不小于UART_TX_ZEROCOPY_MIN时由DMA直接从payload发送，不复制到发送缓冲区。
+ */
+int uart_send_packet(uart_port_t port, const uint8_t *payload, uint16_t len)
+{
+    uint8_t header[3] = {0xAA, (uint8_t)len, (uint8_t)(len >> 8)};
+    uint8_t sum = uart_packet_checksum(payload, len);
+    uart_iovec_t iov[3] = {
+        {header, sizeof(header)},
+        {payload, len},
+        {&sum, 1},
+    };
+
+    return uart_writev(port, iov, 3);
+}
+
+// 异步发送示例：大块数据排队后立即返回，发送完成后在worker线程中回调
+static uint8_t uart_async_block[2048];
+static uart_tx_req_t uart_async_req;
+
+static void uart_async_done(uart_tx_req_t *req, esp_err_t result)
+{
+    printf("异步发送%s: %lu 字节\n", result == ESP_OK ? "完成" : "失败", (unsigned long)req->len);
+}
+
+esp_err_t uart_async_write_example(uart_port_t port)
+{
+    // 上一次请求未完成前不能修改数据和重新提交
+    if (uart_async_req.state == UART_TX_REQ_PENDING)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (uint32_t i = 0; i < sizeof(uart_async_block); i++)
+    {
+        uart_async_block[i] = (uint8_t)i;
+    }
+
+    uart_tx_req_init(&uart_async_req, uart_async_block, sizeof(uart_async_block), uart_async_done, NULL);
+    return uart_write_async(port, &uart_async_req);
+}
+
+// 帧层示例：遥测数据以COBS+CRC16成帧发送，接收任务从缓冲池取帧缓冲区直接接收并解码
+typedef struct
+{
+    uint32_t tick;
+    int16_t temperature;
+    uint16_t voltage_mv;
+} uart_telemetry_t;
+
+static uart_frame_t uart_frames[4];
+static uart_frame_decoder_t uart_frame_dec;
+
+static void uart_on_frame(uart_frame_decoder_t *dec, uart_frame_t *frame, void *arg)
+{
+    if (frame->len == sizeof(uart_telemetry_t))
+    {
+        uart_telemetry_t msg;
+        memcpy(&msg, frame->data, sizeof(msg));
+        printf("遥测: tick=%lu temp=%d mv=%u\n", (unsigned long)msg.tick, msg.temperature, msg.voltage_mv);
+    }
+    // 需要交给其他任务处理时可以把frame传过去，处理完再归还
+    uart_frame_release(dec, frame);
+}
+
+static void uart_frame_rx_task(void *pvParameters)
+{
+    uart_port_t port = (uart_port_t)(uintptr_t)pvParameters;
+
+    while (1)
+    {
+        uint8_t *buf;
+        size_t space = uart_frame_rx_buffer(&uart_frame_dec, &buf);
+        int n = uart_read_bytes(port, buf, space, portMAX_DELAY);
+        if (n > 0)
+        {
+            uart_frame_rx_commit(&uart_frame_dec, (size_t)n);
+        }
+    }
+}
+
+int uart_send_telemetry(uart_port_t port, const uart_telemetry_t *msg)
+{
+    uint8_t out[UART_FRAME_ENCODED_MAX(sizeof(*msg) + 2)];
+    size_t len = uart_frame_encode(UART_FRAME_CRC16, msg, sizeof(*msg), out, sizeof(out));
+    return uart_write_bytes(port, out, len);
+}
+
+esp_err_t uart_frame_example_init(uart_port_t port)
+{
+    uart_frame_decoder_init(&uart_frame_dec, uart_frames, 4, UART_FRAME_CRC16, uart_on_frame, NULL);
+    if (xTaskCreate(uart_frame_rx_task, "uart_frame", 512, (void *)(uintptr_t)port, 3, NULL) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// 接收事件示例：不占用接收任务，收到行结束符后在worker线程中读出完整的行
+static void uart_example_event(uart_port_t port, const uart_event_t *event)
+{
+    char line[64];
+
+    switch (event->type)
+    {
+    case UART_EVENT_PATTERN_DET:
+        // 缓冲区中已有完整的行，读取不会等待；不完整的行留到下次
+        while (uart_readline(port, line, sizeof(line), 0) >= 0)
+        {
+            printf("UART%d: %s\n", port, line);
+        }
+        break;
+    case UART_EVENT_BUFFER_FULL:
+    case UART_EVENT_FIFO_OVF:
+        printf("UART%d 接收溢出\n", port);
+        break;
+    case UART_EVENT_BREAK:
+        printf("UART%d break\n", port);
+        break;
+    default:
+        break;
+    }
+}
+
+esp_err_t uart_event_example_init(uart_port_t port)
+{
+    uart_enable_pattern_det(port, '\n');
+    return uart_set_rx_event(port, 0, 0, uart_example_event);
+}
+
+// 流控示例：RTS引脚（USART3为PB14）在CubeMX中配置为GPIO推挽输出，CTS引脚（PB13）配置为USART3_CTS
+#ifndef UART_EXAMPLE_RTS_GPIO_Port
+#define UART_EXAMPLE_RTS_GPIO_Port GPIOB
+#define UART_EXAMPLE_RTS_Pin GPIO_PIN_14
+#endif
+
+// 接收中断中调用：RTS低电平有效
+static void uart_example_set_rts(uart_port_t port, bool ready)
+{
+    HAL_GPIO_WritePin(UART_EXAMPLE_RTS_GPIO_Port, UART_EXAMPLE_RTS_Pin, ready ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+esp_err_t uart_flow_ctrl_example_init(uart_port_t port)
+{
+    uart_flow_ctrl_t cfg = {
+        .flow_ctrl = UART_HW_FLOWCTRL_CTS_RTS,
+        .rx_high = 0, // 接收缓冲区的3/4
+        .rx_low = 0,  // 接收缓冲区的1/4
+        .set_rts = uart_example_set_rts,
+    };
+    return uart_set_flow_ctrl(port, &cfg);
+}
+
+// RS-485示例：收发器DE由GPIO控制，/RE接地常开接收（发送时会收到自己的数据，打开回波抑制）
+#ifndef UART_EXAMPLE_DE_GPIO_Port
+#define UART_EXAMPLE_DE_GPIO_Port GPIOA
+#define UART_EXAMPLE_DE_Pin GPIO_PIN_1
+#endif
+
+// TC中断中调用：DE高电平有效
+static void uart_example_set_de(uart_port_t port, bool tx)
+{
+    HAL_GPIO_WritePin(UART_EXAMPLE_DE_GPIO_Port, UART_EXAMPLE_DE_Pin, tx ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+esp_err_t uart_rs485_example_init(uart_port_t port)
+{
+    uart_rs485_t cfg = {
+        .enable = true,
+        .echo_suppress = true,
+        .set_de = uart_example_set_de,
+    };
+    return uart_set_rs485(port, &cfg);
+}
+
+// 波特率切换示例：以115200启动，通知对方后双方切换到高波特率，对方不应答时保持原波特率
+esp_err_t uart_baud_switch_example(uart_port_t port, uint32_t baud_rate)
+{
+    char line[32];
+    int len = snprintf(line, sizeof(line), "AT+BAUD=%lu\r\n", (unsigned long)baud_rate);
+
+    uart_write_bytes(port, line, len);
+    if (uart_readline(port, line, sizeof(line), pdMS_TO_TICKS(100)) < 0 || strcmp(line, "OK") != 0)
+    {
+        return ESP_FAIL;
+    }
+    // 应答已收到，uart_set_baudrate等待命令发完后才切换
+    return uart_set_baudrate(port, baud_rate);
+}
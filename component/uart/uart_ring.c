@@ -0,0 +1,200 @@
+#include "uart_ring.h"
+
+void uart_ring_init(uart_ring_t *ring, uint8_t *buf, uint32_t size)
+{
+    ring->buf = buf;
+    ring->size = size;
+    uart_ring_reset(ring);
+}
+
+void uart_ring_reset(uart_ring_t *ring)
+{
+    ring->write = 0;
+    ring->read = 0;
+    ring->last = ring->size;
+    ring->grant = 0;
+    ring->grant_len = 0;
+}
+
+/**
+ * @brief 计算连续写入空间
+ * @param exact true:必须有len字节连续空间 false:尽量多，最多len字节
+ * @return 预留区起始位置，空间不足时返回size（无效位置）
+ */
+static uint32_t ring_grant(uart_ring_t *ring, uint32_t *len, bool exact)
+{
+    uint32_t write = ring->write;
+    uint32_t read = __atomic_load_n(&ring->read, __ATOMIC_ACQUIRE);
+    uint32_t want = *len;
+
+    if (write < read)
+    {
+        // 已回绕：只能写到read之前（留一个字节区分满和空）
+        uint32_t space = read - write - 1;
+        if (space == 0 || (exact && space < want))
+        {
+            return ring->size;
+        }
+        *len = (want < space) ? want : space;
+        return write;
+    }
+
+    uint32_t tail = ring->size - write;
+    if (tail >= want || (!exact && tail > 0))
+    {
+        *len = (want < tail) ? want : tail;
+        return write;
+    }
+
+    // 尾部放不下：从开头写（同样不能追上read）
+    if (read > 1 && (!exact || read - 1 >= want))
+    {
+        *len = (want < read - 1) ? want : read - 1;
+        return 0;
+    }
+
+    return ring->size;
+}
+
+uint8_t *uart_ring_write_reserve(uart_ring_t *ring, uint32_t len)
+{
+    if (len == 0 || len > UART_RING_RESERVE_MAX(ring))
+    {
+        return NULL;
+    }
+
+    uint32_t start = ring_grant(ring, &len, true);
+    if (start == ring->size)
+    {
+        return NULL;
+    }
+
+    ring->grant = start;
+    ring->grant_len = len;
+    return &ring->buf[start];
+}
+
+uint8_t *uart_ring_write_reserve_max(uart_ring_t *ring, uint32_t max, uint32_t *len)
+{
+    *len = 0;
+    if (max == 0)
+    {
+        return NULL;
+    }
+
+    uint32_t granted = max;
+    uint32_t start = ring_grant(ring, &granted, false);
+    if (start == ring->size)
+    {
+        return NULL;
+    }
+
+    ring->grant = start;
+    ring->grant_len = granted;
+    *len = granted;
+    return &ring->buf[start];
+}
+
+void uart_ring_write_commit(uart_ring_t *ring, uint32_t used)
+{
+    uint32_t write = ring->write;
+
+    if (used > ring->grant_len)
+    {
+        used = ring->grant_len;
+    }
+    ring->grant_len = 0;
+    if (used == 0)
+    {
+        return;
+    }
+
+    uint32_t new_write = ring->grant + used;
+
+    if (new_write < write)
+    {
+        // 回绕：尾部[write, size)没有数据，读取方读到write后直接回到开头
+        __atomic_store_n(&ring->last, write, __ATOMIC_RELEASE);
+    }
+    else if (new_write > ring->last)
+    {
+        // 越过了上一次回绕留下的标记，尾部恢复可用
+        __atomic_store_n(&ring->last, ring->size, __ATOMIC_RELEASE);
+    }
+
+    // 数据写入先于写位置对读取方可见
+    __atomic_store_n(&ring->write, new_write, __ATOMIC_RELEASE);
+}
+
+uint8_t *uart_ring_read_acquire(uart_ring_t *ring, uint32_t *len)
+{
+    uint32_t write = __atomic_load_n(&ring->write, __ATOMIC_ACQUIRE);
+    uint32_t last = __atomic_load_n(&ring->last, __ATOMIC_ACQUIRE);
+    uint32_t read = ring->read;
+
+    if (write < read && read >= last)
+    {
+        // 尾部已读完，回到开头
+        read = 0;
+        __atomic_store_n(&ring->read, 0, __ATOMIC_RELEASE);
+    }
+
+    *len = (write < read) ? last - read : write - read;
+    return (*len > 0) ? &ring->buf[read] : NULL;
+}
+
+uint8_t *uart_ring_read_peek(uart_ring_t *ring, uint32_t offset, uint32_t *len)
+{
+    uint32_t write = __atomic_load_n(&ring->write, __ATOMIC_ACQUIRE);
+    uint32_t last = __atomic_load_n(&ring->last, __ATOMIC_ACQUIRE);
+    uint32_t read = ring->read;
+
+    if (write < read)
+    {
+        // 已回绕：先是尾部[read, last)，然后是开头[0, write)
+        uint32_t tail = (last > read) ? last - read : 0;
+        if (offset < tail)
+        {
+            *len = tail - offset;
+            return &ring->buf[read + offset];
+        }
+        offset -= tail;
+        read = 0;
+    }
+
+    if (offset >= write - read)
+    {
+        *len = 0;
+        return NULL;
+    }
+    *len = write - read - offset;
+    return &ring->buf[read + offset];
+}
+
+void uart_ring_read_release(uart_ring_t *ring, uint32_t used)
+{
+    uint32_t read = ring->read + used;
+    uint32_t write = __atomic_load_n(&ring->write, __ATOMIC_ACQUIRE);
+
+    if (write < read && read >= __atomic_load_n(&ring->last, __ATOMIC_ACQUIRE))
+    {
+        read = 0;
+    }
+
+    // 数据读完（DMA发送完成）后才把空间还给写入方
+    __atomic_store_n(&ring->read, read, __ATOMIC_RELEASE);
+}
+
+void uart_ring_read_discard(uart_ring_t *ring)
+{
+    __atomic_store_n(&ring->read, __atomic_load_n(&ring->write, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+uint32_t uart_ring_used(const uart_ring_t *ring)
+{
+    uint32_t write = __atomic_load_n(&ring->write, __ATOMIC_ACQUIRE);
+    uint32_t last = __atomic_load_n(&ring->last, __ATOMIC_ACQUIRE);
+    uint32_t read = __atomic_load_n(&ring->read, __ATOMIC_ACQUIRE);
+
+    return (write < read) ? (last - read) + write : write - read;
+}
@@ -4,12 +4,82 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+// 线程池最大工作线程数
+#ifndef WORKER_POOL_MAX
+#define WORKER_POOL_MAX 4
+#endif
+
+// 中断提交缓冲区大小（必须为2的幂）
+#ifndef WORKER_ISR_RING_SIZE
+#define WORKER_ISR_RING_SIZE 16
+#endif
+
+// 工作线程每次唤醒最多连续取出的工作项数
+// （整批执行完才检查关闭/刷新状态，新到的高优先级任务最多等待一批）
+#ifndef WORKER_DRAIN_BATCH
+#define WORKER_DRAIN_BATCH 4
+#endif
+
+// 定时器时间轮槽数（必须为2的幂，每槽对应一个tick）
+#ifndef WORKER_TIMER_WHEEL_SIZE
+#define WORKER_TIMER_WHEEL_SIZE 32
+#endif
+
+// 按名称统计执行时间和排队时间（DWT周期计数）
+#ifndef WORKER_PROFILE_ENABLE
+#define WORKER_PROFILE_ENABLE 1
+#endif
+
+// 剖析统计表项数（超出后的名称合并到最后一项"<other>"）
+#ifndef WORKER_PROFILE_SLOTS
+#define WORKER_PROFILE_SLOTS 16
+#endif
+
+// worker_future_wait使用的任务通知下标（不占用任务默认的通知0，
+// 需要configTASK_NOTIFICATION_ARRAY_ENTRIES大于该值）
+#ifndef WORKER_FUTURE_NOTIFY_INDEX
+#define WORKER_FUTURE_NOTIFY_INDEX 1
+#endif
+
+// 静态分配模式：节点池、线程栈、控制块和信号量都放在静态存储区，不从FreeRTOS堆分配
+// （需要configSUPPORT_STATIC_ALLOCATION=1）
+#ifndef WORKER_STATIC_ALLOC
+#define WORKER_STATIC_ALLOC 0
+#endif
+
+#if WORKER_STATIC_ALLOC
+// 默认工作队列的静态容量（worker_thread_init/worker_pool_init的参数不能超过）
+#ifndef WORKER_STATIC_THREAD_NUM
+#define WORKER_STATIC_THREAD_NUM 1
+#endif
+#ifndef WORKER_STATIC_ITEM_NUM
+#define WORKER_STATIC_ITEM_NUM 16
+#endif
+#ifndef WORKER_STATIC_STACK_SIZE
+#define WORKER_STATIC_STACK_SIZE 2048 // 每个线程的栈大小（字节）
+#endif
+
+// workqueue_create可创建的工作队列数（节点池和线程栈由config提供）
+#ifndef WORKER_STATIC_QUEUE_NUM
+#define WORKER_STATIC_QUEUE_NUM 2
+#endif
+#endif
+
+// 静态存储所在的段（可定义为FASTDATA，把线程栈放到快速RAM）
+#ifndef WORKER_STATIC_SECTION
+#define WORKER_STATIC_SECTION
+#endif
+
+// 直方图桶数：桶0为<1us，桶k为[2^(k-1), 2^k)us，最后一个桶包含更大的值
+#define WORKER_PROFILE_HIST_BINS 16
+
     // Worker线程状态
     typedef enum
     {
@@ -23,27 +93,224 @@ extern "C"
     typedef enum
     {
         WORKER_FLAG_NONE = 0x00,
-        WORKER_FLAG_HIGH_PRIO = 0x01 // 高优先级任务（插入队列头部）
+        WORKER_FLAG_HIGH_PRIO = 0x01, // 高优先级任务（prio未指定时归入WORKER_PRIO_HIGH）
+        WORKER_FLAG_DEADLINE = 0x02   // 截止时间任务（按deadline最早优先调度，先于所有优先级类别）
     } worker_flags_t;
 
+    // 工作项优先级类别（类别之间高者优先，同类别内先进先出）
+    typedef enum
+    {
+        WORKER_PRIO_DEFAULT = 0, // 未指定：有WORKER_FLAG_HIGH_PRIO时为HIGH，否则为NORMAL
+        WORKER_PRIO_LOW,         // 批量任务（日志、统计等）
+        WORKER_PRIO_NORMAL,      // 普通任务
+        WORKER_PRIO_HIGH,        // 高优先级任务
+        WORKER_PRIO_CRITICAL,    // 关键任务（控制环路等）
+        WORKER_PRIO_MAX
+    } worker_prio_t;
+
+// 优先级类别数量
+#define WORKER_PRIO_CLASS_NUM (WORKER_PRIO_MAX - 1)
+
+    // 队列满（节点池耗尽）时的处理策略
+    typedef enum
+    {
+        WORKER_OVERFLOW_DEFAULT = 0, // 工作项未指定：使用工作队列的策略
+        WORKER_OVERFLOW_REJECT,      // 立即返回失败（工作队列默认策略）
+        WORKER_OVERFLOW_BLOCK,       // 阻塞等待空闲节点，最多等待工作队列的block_timeout_ms
+        WORKER_OVERFLOW_DROP_OLDEST, // 丢弃排队最久的同级或更低优先级工作项，腾出节点放入新项
+        WORKER_OVERFLOW_COALESCE     // 队列中已有相同回调的工作项时合并（新项不入队）；
+                                     // 带future的工作项不合并（无法确定由哪一次执行完成），按REJECT处理
+    } worker_overflow_t;
+
     // 工作回调函数类型
     typedef void (*worker_cb_t)(void *arg);
 
+    // 完成句柄状态
+    typedef enum
+    {
+        WORKER_FUTURE_IDLE = 0,  // 未提交
+        WORKER_FUTURE_PENDING,   // 已提交，尚未执行完毕
+        WORKER_FUTURE_DONE,      // 回调已执行完毕
+        WORKER_FUTURE_CANCELLED  // 未执行即被丢弃（工作队列删除等）
+    } worker_future_state_t;
+
+    // 工作项完成句柄，由调用者分配，随工作项提交
+    // 工作项被接受后进入PENDING，回调返回后变为DONE并唤醒等待者；
+    // 处于PENDING期间必须保持有效（等待超时返回后也一样）
+    typedef struct
+    {
+        volatile uint8_t state; // 内部使用：worker_future_state_t
+        TaskHandle_t waiter;    // 内部使用：等待完成的任务
+    } worker_future_t;
+
+/**
+ * @brief 静态初始化完成句柄
+ */
+#define WORKER_FUTURE_INIT               \
+    {                                    \
+        .state = WORKER_FUTURE_IDLE,     \
+        .waiter = NULL                   \
+    }
+
     // 工作队列项结构
     typedef struct
     {
-        worker_cb_t cb;   // 工作回调函数
-        void *arg;        // 回调函数参数
-        uint32_t flags;   // 工作标志
-        const char *name; // 任务名称（调试用）
+        worker_cb_t cb;          // 工作回调函数
+        void *arg;               // 回调函数参数
+        uint32_t flags;          // 工作标志
+        const char *name;        // 任务名称（调试用）
+        TickType_t deadline;     // 截止tick（WORKER_FLAG_DEADLINE时有效，需在此前执行完毕）
+        uint8_t prio;            // 优先级类别（worker_prio_t）
+        worker_future_t *future; // 完成句柄（可为NULL）
+        uint8_t overflow;        // 队列满时的处理策略（worker_overflow_t）
     } worker_queue_item_t;
 
+    // 工作项被丢弃回调（DROP_OLDEST挤出的工作项，调用者在此释放arg等资源）
+    typedef void (*worker_drop_cb_t)(const worker_queue_item_t *item);
+
+    // 单个名称的剖析统计（时间单位：微秒）
+    typedef struct
+    {
+        const char *name;                            // 工作项名称
+        uint32_t count;                              // 执行次数
+        uint32_t exec_min;                           // 最短执行时间
+        uint32_t exec_max;                           // 最长执行时间
+        uint32_t exec_mean;                          // 平均执行时间
+        uint32_t wait_min;                           // 最短排队时间（提交到开始执行）
+        uint32_t wait_max;                           // 最长排队时间
+        uint32_t wait_mean;                          // 平均排队时间
+        uint16_t exec_hist[WORKER_PROFILE_HIST_BINS]; // 执行时间log2直方图
+        uint16_t wait_hist[WORKER_PROFILE_HIST_BINS]; // 排队时间log2直方图
+    } worker_profile_entry_t;
+
+    // 工作队列句柄（每个工作队列拥有独立的线程、节点池、时间轮和统计）
+    typedef struct worker worker_t;
+
+    // 工作队列创建参数
+    typedef struct
+    {
+        const char *name;          // 工作队列名称（唯一，同时作为线程名前缀，需在整个生命周期有效）
+        uint8_t thread_num;        // 工作线程数量（1 ~ WORKER_POOL_MAX）
+        uint32_t item_num;         // 工作队列最大项数（节点池大小）
+        uint32_t stack_size;       // 每个线程的栈大小（字节）
+        UBaseType_t priority;      // 线程优先级
+        uint8_t overflow;          // 队列满时的处理策略（worker_overflow_t，DEFAULT等同REJECT）
+        uint32_t block_timeout_ms; // BLOCK策略的最长等待时间
+        worker_drop_cb_t drop_cb;  // 工作项被挤出时的回调（可为NULL）
+        struct worker_work *nodes; // 静态分配模式：节点池存储（item_num项，见WORKER_STATIC_STORAGE）
+        StackType_t *stacks;       // 静态分配模式：线程栈存储（thread_num × stack_size字节）
+    } worker_config_t;
+
+    // 工作队列统计
+    typedef struct
+    {
+        uint32_t thread_num;      // 工作线程数量
+        uint32_t item_num;        // 工作队列最大项数
+        uint32_t queue_length;    // 当前等待的工作项数（含中断提交未转入的）
+        uint32_t high_water;      // 等待工作项数的历史最大值
+        uint32_t accepted;        // 已接受的提交数
+        uint32_t dropped;         // 丢弃的工作项数（队列满被拒绝、被挤出、中断缓冲区满）
+        uint32_t coalesced;       // 与队列中相同回调合并的提交数
+        uint32_t executed;        // 已执行的工作项数
+        uint32_t stolen;          // 被空闲线程窃取执行的工作项数
+        uint32_t isr_dropped;     // 中断提交因缓冲区满而丢弃的数量（已计入dropped）
+        uint32_t deadline_missed; // 错过截止时间的次数
+        uint32_t wakeups;         // 工作线程从等待中被唤醒的总次数
+        uint32_t uptime_ms;       // 创建以来的运行时间
+        uint32_t busy_ms;         // 所有线程执行工作项的累计时间
+        uint32_t idle_ms;         // 所有线程的累计空闲时间（利用率 = busy_ms / (busy_ms + idle_ms)）
+    } worker_stats_t;
+
+    // 截止时间错过回调（在工作线程上下文中调用）
+    typedef void (*worker_deadline_miss_cb_t)(const worker_queue_item_t *item, TickType_t lateness);
+
+    // 侵入式工作对象（类似Linux work_struct）
+    // 由调用者静态分配，直接链入工作队列，不占用节点池；已在队列中时重复提交不会重复入队
+    typedef struct worker_work
+    {
+        struct worker_work *next; // 内部使用：队列链表
+        worker_queue_item_t item; // 工作项
+        volatile uint8_t state;   // 内部使用：排队状态
+        uint32_t stamp;           // 内部使用：入队时间（DWT周期，仅用于性能统计）
+        uint32_t seq;             // 内部使用：节点池工作项的提交序号（DROP_OLDEST按此找最早的）
+    } worker_work_t;
+
+/**
+ * @brief 静态初始化侵入式工作对象
+ * @param func 回调函数
+ * @param data 回调参数
+ */
+#define WORKER_WORK_INIT(func, data)   \
+    {                                  \
+        .next = NULL,                  \
+        .item = {                      \
+            .cb = (func),              \
+            .arg = (data),             \
+            .flags = WORKER_FLAG_NONE, \
+            .name = #func},            \
+        .state = 0,                    \
+        .stamp = 0,                    \
+        .seq = 0                       \
+    }
+
+/**
+ * @brief 定义静态分配模式下workqueue_create所需的节点池和线程栈
+ *
+ * 同一份代码可在两种模式下编译：动态分配模式下只定义空数组。
+ *
+ * 示例：
+ *   WORKER_STATIC_STORAGE(io_wq, 1, 8, 1024);
+ *   worker_config_t config = {.name = "io_wq", .thread_num = 1, .item_num = 8, .stack_size = 1024,
+ *                             .priority = 6, .nodes = io_wq_nodes, .stacks = io_wq_stacks};
+ */
+#if WORKER_STATIC_ALLOC
+#define WORKER_STATIC_STORAGE(prefix, thread_num, item_num, stack_size)   \
+    WORKER_STATIC_SECTION static worker_work_t prefix##_nodes[item_num]; \
+    WORKER_STATIC_SECTION static StackType_t prefix##_stacks[(thread_num) * ((stack_size) / sizeof(StackType_t))]
+#else
+// 动态分配模式下不占用存储（GNU零长度数组），config中的nodes/stacks被忽略
+#define WORKER_STATIC_STORAGE(prefix, thread_num, item_num, stack_size) \
+    static worker_work_t prefix##_nodes[0] __attribute__((unused));     \
+    static StackType_t prefix##_stacks[0] __attribute__((unused))
+#endif
+
+    // 定时工作对象（延迟/周期执行），由调用者静态分配
+    // 挂在worker的哈希时间轮上，到期时提交内部的work，大量定时任务共用worker线程
+    typedef struct worker_timer
+    {
+        struct worker_timer *next; // 内部使用：时间轮槽链表
+        struct worker *wq;         // 内部使用：所在时间轮的工作队列
+        worker_work_t work;        // 到期时提交的工作对象
+        TickType_t expires;        // 内部使用：到期tick
+        TickType_t period;         // 内部使用：周期tick（0为单次）
+        volatile uint8_t armed;    // 内部使用：是否在时间轮上
+    } worker_timer_t;
+
+/**
+ * @brief 静态初始化定时工作对象
+ * @param func 回调函数
+ * @param data 回调参数
+ */
+#define WORKER_TIMER_INIT(func, data)         \
+    {                                         \
+        .next = NULL,                         \
+        .wq = NULL,                           \
+        .work = WORKER_WORK_INIT(func, data), \
+        .expires = 0,                         \
+        .period = 0,                          \
+        .armed = 0                            \
+    }
+
     // =============================================================================
     // 基础Worker接口
     // =============================================================================
 
     /**
      * @brief 初始化worker线程
+     *
+     * 静态分配模式下使用WORKER_STATIC_ITEM_NUM/WORKER_STATIC_STACK_SIZE的静态存储，
+     * 参数超出静态容量时返回失败。
+     *
      * @param item_num 工作队列最大项数
      * @param stack_size 线程栈大小
      * @param prior 线程优先级
@@ -52,18 +319,151 @@ extern "C"
     int worker_thread_init(int item_num, int stack_size, int prior);
 
     /**
-     * @brief 销毁worker线程
+     * @brief 初始化worker线程池
+     *
+     * 每个工作线程拥有自己的本地队列，空闲线程会从忙碌线程的队列中窃取任务，
+     * 避免一个耗时回调阻塞其后所有任务。worker_send等提交接口保持不变。
+     *
+     * @param thread_num 工作线程数量（1 ~ WORKER_POOL_MAX）
+     * @param item_num 工作队列最大项数（所有线程共享）
+     * @param stack_size 每个线程的栈大小
+     * @param prior 线程优先级
+     * @return 0:成功 -1:已初始化或参数错误 -2:内存不足 -3:创建信号量失败 -4:创建线程失败
+     */
+    int worker_pool_init(int thread_num, int item_num, int stack_size, int prior);
+
+    /**
+     * @brief 销毁worker线程（默认工作队列）
      * @return 0:成功 -1:失败
      */
     int worker_thread_destroy(void);
 
     /**
      * @brief 发送工作任务到队列
+     *
+     * 队列满时按item->overflow处理，未指定时使用工作队列的策略（默认REJECT）。
+     * 返回1表示已与队列中相同回调的工作项合并，本项未入队，arg仍归调用者；
+     * 带future的工作项不会被合并。
+     *
      * @param item 工作项指针
-     * @return 0:成功 -1:失败
+     * @return 0:成功 1:已合并 -1:失败（队列满被拒绝、等待超时或未初始化）
      */
     int worker_send(worker_queue_item_t *item);
 
+    /**
+     * @brief 设置队列满时的处理策略
+     * @param policy 处理策略（DEFAULT等同REJECT）
+     * @param block_timeout_ms BLOCK策略的最长等待时间（毫秒）
+     * @return 0:成功 -1:未初始化或参数错误
+     */
+    int worker_set_overflow_policy(worker_overflow_t policy, uint32_t block_timeout_ms);
+
+    /**
+     * @brief 设置工作项被挤出时的回调（DROP_OLDEST策略）
+     * @param cb 回调函数（NULL取消），在提交者上下文中调用
+     * @return 0:成功 -1:未初始化
+     */
+    int worker_set_drop_callback(worker_drop_cb_t cb);
+
+    /**
+     * @brief 批量发送工作任务
+     *
+     * 在一个临界区内放入所有工作项，每个被分配到任务的线程只通知一次。
+     * 节点池不足时只放入前面能放下的部分（不应用溢出策略，未放入的计入dropped，由调用者处理）。
+     *
+     * @param items 工作项数组
+     * @param n 工作项数量
+     * @return 成功放入的数量（0 ~ n） -1:未初始化或参数错误
+     */
+    int worker_send_batch(const worker_queue_item_t *items, uint32_t n);
+
+    /**
+     * @brief 在中断中发送工作任务
+     *
+     * 工作项写入无锁多生产者环形缓冲区（不进入临界区，可被更高优先级中断嵌套调用），
+     * 再通过任务通知唤醒工作线程。调用者在中断退出前执行portYIELD_FROM_ISR(*higher_prio_woken)。
+     * 缓冲区满时不应用溢出策略，直接丢弃并计入dropped。
+     *
+     * @param item 工作项指针
+     * @param higher_prio_woken 输出：是否唤醒了更高优先级的任务（可为NULL）
+     * @return 0:成功 -1:缓冲区满 -2:未初始化或参数错误
+     */
+    int worker_send_from_isr(const worker_queue_item_t *item, BaseType_t *higher_prio_woken);
+
+    /**
+     * @brief 初始化侵入式工作对象
+     * @param work 工作对象指针（需在整个使用期间有效）
+     * @param cb 回调函数
+     * @param arg 回调参数
+     * @param name 名称（调试用）
+     */
+    void worker_work_init(worker_work_t *work, worker_cb_t cb, void *arg, const char *name);
+
+    /**
+     * @brief 提交侵入式工作对象
+     *
+     * 对象已在队列中时直接返回，不会重复入队；回调开始执行前清除排队状态，
+     * 因此执行期间再次提交会在本次执行后再运行一次。
+     *
+     * @param work 工作对象指针
+     * @return 0:已入队 1:已在队列中 -1:未初始化或参数错误
+     */
+    int worker_queue_work(worker_work_t *work);
+
+    /**
+     * @brief 在中断中提交侵入式工作对象（无锁，不会因队列满而失败）
+     * @param work 工作对象指针
+     * @param higher_prio_woken 输出：是否唤醒了更高优先级的任务（可为NULL）
+     * @return 0:已入队 1:已在队列中 -1:未初始化或参数错误
+     */
+    int worker_queue_work_from_isr(worker_work_t *work, BaseType_t *higher_prio_woken);
+
+    /**
+     * @brief 查询工作对象是否在队列中等待执行
+     * @param work 工作对象指针
+     * @return true:等待执行 false:未排队
+     */
+    bool worker_work_is_pending(const worker_work_t *work);
+
+    /**
+     * @brief 初始化定时工作对象
+     * @param timer 定时对象指针（需在整个使用期间有效）
+     * @param cb 回调函数
+     * @param arg 回调参数
+     * @param name 名称（调试用）
+     */
+    void worker_timer_init(worker_timer_t *timer, worker_cb_t cb, void *arg, const char *name);
+
+    /**
+     * @brief 延迟执行工作
+     *
+     * 定时对象已在时间轮上时按新的延迟重新调度。到期时以worker_queue_work语义提交，
+     * 上一次提交尚未执行时不会重复排队。
+     *
+     * @param timer 定时对象指针
+     * @param delay_ms 延迟时间（毫秒），0表示立即提交
+     * @return 0:成功 -1:未初始化或参数错误
+     */
+    int worker_send_delayed(worker_timer_t *timer, uint32_t delay_ms);
+
+    /**
+     * @brief 周期执行工作
+     *
+     * 首次在period_ms后执行，之后按固定周期执行（到期时间累加，不随回调耗时漂移）。
+     *
+     * @param timer 定时对象指针
+     * @param period_ms 周期（毫秒，需大于0）
+     * @return 0:成功 -1:未初始化或参数错误
+     */
+    int worker_send_periodic(worker_timer_t *timer, uint32_t period_ms);
+
+    /**
+     * @brief 取消定时工作（已到期并提交的工作仍会执行）
+     * @param timer 定时对象指针
+     * @return 0:已取消 1:未在时间轮上 -1:参数错误
+     */
+    int worker_timer_cancel(worker_timer_t *timer);
+
     /**
      * @brief 发送工作任务到队列（带超时）
      * @param item 工作项指针
@@ -73,12 +473,122 @@ extern "C"
     int worker_send_timeout(worker_queue_item_t *item, uint32_t timeout_ms);
 
     /**
-     * @brief 刷新工作队列（等待所有任务完成）
+     * @brief 刷新工作队列（等待调用前提交的任务全部执行完毕）
+     *
+     * 只等待调用前已被接受的工作项（含正在执行的），之后提交的不影响返回，
+     * 持续有新任务提交时也能在有限时间内完成。不能在该队列的工作线程中调用。
+     *
      * @param timeout_ms 超时时间（毫秒）
-     * @return 0:成功 -1:超时
+     * @return 0:成功 -1:超时、未初始化或在工作线程中调用
      */
     int worker_flush(uint32_t timeout_ms);
 
+    /**
+     * @brief 初始化完成句柄
+     * @param future 完成句柄指针
+     */
+    void worker_future_init(worker_future_t *future);
+
+    /**
+     * @brief 等待工作项执行完毕
+     *
+     * 等待期间阻塞在调用任务下标为WORKER_FUTURE_NOTIFY_INDEX的任务通知上，完成时立即唤醒，
+     * 不需要轮询；不影响调用任务在默认通知上收发的其他通知。
+     *
+     * @param future 完成句柄（通过worker_queue_item_t.future随工作项提交）
+     * @param timeout_ms 超时时间（毫秒），0为只检查一次
+     * @return 0:已完成 -1:超时 -2:未提交或参数错误 -3:已取消
+     */
+    int worker_future_wait(worker_future_t *future, uint32_t timeout_ms);
+
+    /**
+     * @brief 查询完成句柄状态（不阻塞，可在中断中调用）
+     * @param future 完成句柄
+     * @return worker_future_state_t
+     */
+    worker_future_state_t worker_future_poll(const worker_future_t *future);
+
+    // =============================================================================
+    // 多工作队列接口
+    // =============================================================================
+    //
+    // 以上worker_*接口作用于默认工作队列（worker_thread_init/worker_pool_init创建）。
+    // 需要隔离的场景可另建工作队列，例如高优先级、小深度的I/O队列和低优先级的批量队列，
+    // 各自拥有线程、栈、节点池、时间轮和统计，互不阻塞。
+
+    /**
+     * @brief 创建工作队列
+     *
+     * 静态分配模式下控制块取自WORKER_STATIC_QUEUE_NUM个静态槽位，config必须提供
+     * nodes和stacks（见WORKER_STATIC_STORAGE）。
+     *
+     * @param config 创建参数（name需唯一）
+     * @return 工作队列句柄，参数错误、名称重复或资源不足时返回NULL
+     */
+    worker_t *workqueue_create(const worker_config_t *config);
+
+    /**
+     * @brief 删除工作队列（等待线程退出，不能在该队列的工作线程中调用）
+     *
+     * 仍在排队的侵入式工作对象和定时对象被摘除，之后可重新提交到其他队列。
+     * 对默认工作队列调用等同于worker_thread_destroy。
+     *
+     * @param wq 工作队列句柄
+     * @return 0:成功 -1:未初始化或在自身工作线程中调用
+     */
+    int workqueue_delete(worker_t *wq);
+
+    /**
+     * @brief 按名称查找工作队列
+     * @param name 工作队列名称（默认工作队列为"default"）
+     * @return 工作队列句柄，未找到返回NULL
+     */
+    worker_t *workqueue_find(const char *name);
+
+    /**
+     * @brief 获取默认工作队列
+     * @return 默认工作队列句柄，未初始化时返回NULL
+     */
+    worker_t *workqueue_get_default(void);
+
+    /**
+     * @brief 获取工作队列名称
+     */
+    const char *workqueue_get_name(const worker_t *wq);
+
+    // 以下接口与对应的worker_*接口语义和返回值相同，只是作用于指定的工作队列
+    int workqueue_send(worker_t *wq, worker_queue_item_t *item);
+    int workqueue_set_overflow_policy(worker_t *wq, worker_overflow_t policy, uint32_t block_timeout_ms);
+    int workqueue_set_drop_callback(worker_t *wq, worker_drop_cb_t cb);
+    int workqueue_send_batch(worker_t *wq, const worker_queue_item_t *items, uint32_t n);
+    int workqueue_send_from_isr(worker_t *wq, const worker_queue_item_t *item, BaseType_t *higher_prio_woken);
+    int workqueue_send_timeout(worker_t *wq, worker_queue_item_t *item, uint32_t timeout_ms);
+    int workqueue_queue_work(worker_t *wq, worker_work_t *work);
+    int workqueue_queue_work_from_isr(worker_t *wq, worker_work_t *work, BaseType_t *higher_prio_woken);
+
+    /**
+     * @brief 在指定工作队列上延迟/周期执行（定时对象已挂在其他队列时先从原队列摘除）
+     */
+    int workqueue_send_delayed(worker_t *wq, worker_timer_t *timer, uint32_t delay_ms);
+    int workqueue_send_periodic(worker_t *wq, worker_timer_t *timer, uint32_t period_ms);
+
+    int workqueue_flush(worker_t *wq, uint32_t timeout_ms);
+    worker_state_t workqueue_get_state(const worker_t *wq);
+    void workqueue_print_status(const worker_t *wq);
+    uint32_t workqueue_get_queue_length(const worker_t *wq);
+    uint32_t workqueue_get_thread_num(const worker_t *wq);
+    uint32_t workqueue_get_deadline_misses(const worker_t *wq);
+    int workqueue_suspend(worker_t *wq);
+    int workqueue_resume(worker_t *wq);
+
+    /**
+     * @brief 获取工作队列统计
+     * @param wq 工作队列句柄
+     * @param stats 输出：统计快照
+     * @return 0:成功 -1:未初始化或参数错误
+     */
+    int workqueue_get_stats(const worker_t *wq, worker_stats_t *stats);
+
 // =============================================================================
 // 便利宏定义
 // =============================================================================
@@ -136,8 +646,62 @@ extern "C"
      */
     uint32_t worker_get_queue_length(void);
 
+    /**
+     * @brief 获取工作线程数量
+     * @return 工作线程数，未初始化时返回0
+     */
+    uint32_t worker_get_thread_num(void);
+
+    /**
+     * @brief 获取默认工作队列统计
+     * @param stats 输出：统计快照
+     * @return 0:成功 -1:未初始化或参数错误
+     */
+    int worker_get_stats(worker_stats_t *stats);
+
+    /**
+     * @brief 获取错过截止时间的工作项数量
+     * @return 累计错过截止时间的次数
+     */
+    uint32_t worker_get_deadline_misses(void);
+
+    /**
+     * @brief 设置截止时间错过回调
+     * @param cb 回调函数（NULL取消）
+     */
+    void worker_set_deadline_miss_callback(worker_deadline_miss_cb_t cb);
+
+    /**
+     * @brief 获取剖析统计快照
+     * @param entries 输出数组
+     * @param max 数组项数
+     * @return 实际写入的项数（未启用剖析时返回0）
+     */
+    uint32_t worker_profile_get(worker_profile_entry_t *entries, uint32_t max);
+
+    /**
+     * @brief 以CSV格式导出剖析统计
+     *
+     * 首行为表头：name,count,exec_min,exec_mean,exec_max,wait_min,wait_mean,wait_max,exec_hist,wait_hist，
+     * 每个名称一行，时间单位为微秒，直方图各桶以'|'分隔。
+     *
+     * @param buf 输出缓冲区
+     * @param size 缓冲区大小
+     * @return 写入的字符数（不含结尾'\0'，缓冲区不足时截断到整行）
+     */
+    int worker_profile_dump(char *buf, size_t size);
+
+    /**
+     * @brief 清空剖析统计
+     */
+    void worker_profile_reset(void);
+
     /**
      * @brief 暂停worker线程
+     *
+     * 通过控制消息通知线程，等待正在执行的工作项完成后返回；暂停期间提交的工作项
+     * 保留在队列中，恢复后执行。不能在该worker的工作线程中调用。
+     *
      * @return 0:成功 -1:失败
      */
     int worker_suspend(void);
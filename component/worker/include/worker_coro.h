@@ -0,0 +1,255 @@
+#pragma once
+
+#include "worker.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// =============================================================================
+// 无栈协程工作项（protothread风格）
+// =============================================================================
+//
+// 协程函数每次被worker调用时从上次让出的位置继续执行，等待期间不占用工作线程，
+// 大量并发的I/O流程（传感器事务、分段收发等）共用worker线程的栈。
+//
+// 限制（与protothread相同）：
+// - 局部变量在让出后不保留，需要跨等待保存的状态放在arg指向的结构中
+// - 协程函数内不能使用switch语句，同一行不能有两个等待宏
+// - 只能在协程函数本身中等待，不能在其调用的子函数中等待
+//
+// 示例：
+//   static int sensor_flow(worker_coro_t *co, void *arg)
+//   {
+//       sensor_ctx_t *ctx = arg;
+//       WORKER_CORO_BEGIN(co);
+//       i2c_start_read(ctx);                                       // 启动DMA，完成中断中调用worker_coro_wake_from_isr
+//       WORKER_CORO_WAIT_UNTIL(co, ctx->rx_done, 20);
+//       if (worker_coro_timed_out(co))
+//       {
+//           WORKER_CORO_EXIT(co);
+//       }
+//       WORKER_CORO_DELAY(co, 100);
+//       WORKER_CORO_END(co);
+//   }
+
+// 等待不超时
+#define WORKER_CORO_FOREVER UINT32_MAX
+
+    // 协程函数返回值（由宏产生，协程函数不直接返回）
+    typedef enum
+    {
+        WORKER_CORO_WAITING = 0, // 等待条件、信号量或超时，由唤醒或定时恢复
+        WORKER_CORO_YIELDED,     // 主动让出，重新排队后继续
+        WORKER_CORO_EXITED,      // 提前退出
+        WORKER_CORO_ENDED        // 执行到WORKER_CORO_END
+    } worker_coro_ret_t;
+
+    // 协程状态
+    typedef enum
+    {
+        WORKER_CORO_IDLE = 0, // 未启动
+        WORKER_CORO_RUNNING,  // 运行中（排队、执行或等待）
+        WORKER_CORO_DONE      // 已结束或已取消
+    } worker_coro_state_t;
+
+    struct worker_coro;
+    struct worker_sem;
+
+    // 协程函数
+    typedef int (*worker_coro_fn_t)(struct worker_coro *co, void *arg);
+
+    // 协程控制块，由调用者静态分配
+    typedef struct worker_coro
+    {
+        worker_timer_t timer;          // 内部使用：work用于恢复执行，定时用于等待超时
+        struct worker *wq;             // 内部使用：运行所在的工作队列
+        worker_coro_fn_t fn;           // 协程函数
+        void *arg;                     // 协程参数（保存跨等待的状态）
+        struct worker_coro *wait_next; // 内部使用：信号量等待链表
+        struct worker_sem *wait_sem;   // 内部使用：正在等待的信号量
+        TickType_t deadline;           // 内部使用：当前等待的超时tick
+        uint16_t lc;                   // 内部使用：恢复位置（行号）
+        uint8_t wait_flags;            // 内部使用：等待超时状态
+        volatile uint8_t exec_flags;   // 内部使用：执行状态（防止多线程队列上重入）
+        volatile uint8_t state;        // worker_coro_state_t
+    } worker_coro_t;
+
+    // 协程可等待的计数信号量（可在中断中释放）
+    typedef struct worker_sem
+    {
+        volatile uint32_t count; // 当前计数
+        uint32_t max_count;      // 最大计数
+        worker_coro_t *waiters;  // 内部使用：等待的协程（先进先出）
+    } worker_sem_t;
+
+// =============================================================================
+// 协程宏
+// =============================================================================
+
+/**
+ * @brief 协程函数开始（函数体第一条语句）
+ */
+#define WORKER_CORO_BEGIN(co) \
+    switch ((co)->lc)         \
+    {                         \
+    case 0:
+
+/**
+ * @brief 协程函数结束（函数体最后一条语句）
+ */
+#define WORKER_CORO_END(co) \
+    }                       \
+    (co)->lc = 0;           \
+    return WORKER_CORO_ENDED
+
+/**
+ * @brief 让出worker，重新排到队尾后继续执行
+ */
+#define WORKER_CORO_YIELD(co)       \
+    do                              \
+    {                               \
+        (co)->lc = __LINE__;        \
+        return WORKER_CORO_YIELDED; \
+    case __LINE__:;                 \
+    } while (0)
+
+/**
+ * @brief 等待条件成立，最多等待timeout_ms（WORKER_CORO_FOREVER为不超时）
+ *
+ * 每次被唤醒（worker_coro_wake或超时）时重新检查条件，超时后继续执行，
+ * 可用worker_coro_timed_out判断。
+ */
+#define WORKER_CORO_WAIT_UNTIL(co, cond, timeout_ms)  \
+    do                                                \
+    {                                                 \
+        worker_coro_wait_begin((co), (timeout_ms));   \
+        (co)->lc = __LINE__;                          \
+        __attribute__((fallthrough));                 \
+    case __LINE__:                                    \
+        if (!(cond) && !worker_coro_wait_expired(co)) \
+        {                                             \
+            return WORKER_CORO_WAITING;               \
+        }                                             \
+        worker_coro_wait_end(co);                     \
+    } while (0)
+
+/**
+ * @brief 延迟ms毫秒后继续执行
+ */
+#define WORKER_CORO_DELAY(co, ms) WORKER_CORO_WAIT_UNTIL((co), 0, (ms))
+
+/**
+ * @brief 获取信号量，最多等待timeout_ms（超时后worker_coro_timed_out为true）
+ */
+#define WORKER_CORO_SEM_TAKE(co, sem, timeout_ms)                                      \
+    do                                                                                 \
+    {                                                                                  \
+        WORKER_CORO_WAIT_UNTIL((co), worker_coro_sem_poll((co), (sem)), (timeout_ms)); \
+        if (worker_coro_timed_out(co))                                                 \
+        {                                                                              \
+            worker_sem_cancel_wait((sem), (co));                                       \
+        }                                                                              \
+    } while (0)
+
+/**
+ * @brief 提前结束协程
+ */
+#define WORKER_CORO_EXIT(co)       \
+    do                             \
+    {                              \
+        (co)->lc = 0;              \
+        return WORKER_CORO_EXITED; \
+    } while (0)
+
+    // =============================================================================
+    // 协程接口
+    // =============================================================================
+
+    /**
+     * @brief 初始化协程
+     * @param co 协程控制块（需在整个运行期间有效）
+     * @param fn 协程函数
+     * @param arg 协程参数
+     * @param name 名称（调试和剖析用）
+     */
+    void worker_coro_init(worker_coro_t *co, worker_coro_fn_t fn, void *arg, const char *name);
+
+    /**
+     * @brief 在默认工作队列上启动协程
+     * @param co 协程控制块
+     * @return 0:成功 -1:未初始化、参数错误或协程正在运行
+     */
+    int worker_coro_start(worker_coro_t *co);
+
+    /**
+     * @brief 在指定工作队列上启动协程
+     */
+    int workqueue_coro_start(worker_t *wq, worker_coro_t *co);
+
+    /**
+     * @brief 唤醒等待中的协程重新检查等待条件（条件未成立时继续等待）
+     * @param co 协程控制块
+     * @return 0:已排队 1:已在队列中 -1:协程未运行
+     */
+    int worker_coro_wake(worker_coro_t *co);
+
+    /**
+     * @brief 在中断中唤醒协程（DMA/I2C完成中断等）
+     * @param co 协程控制块
+     * @param higher_prio_woken 输出：是否唤醒了更高优先级的任务（可为NULL）
+     * @return 0:已排队 1:已在队列中 -1:协程未运行
+     */
+    int worker_coro_wake_from_isr(worker_coro_t *co, BaseType_t *higher_prio_woken);
+
+    /**
+     * @brief 取消协程（正在执行的一步执行完后不再继续）
+     *
+     * 协程等待信号量时需由调用者保证信号量仍有效。
+     *
+     * @param co 协程控制块
+     * @return 0:已取消 -1:协程未运行
+     */
+    int worker_coro_cancel(worker_coro_t *co);
+
+    /**
+     * @brief 查询协程状态
+     */
+    worker_coro_state_t worker_coro_get_state(const worker_coro_t *co);
+
+    /**
+     * @brief 上一次等待是否因超时结束
+     */
+    bool worker_coro_timed_out(const worker_coro_t *co);
+
+    /**
+     * @brief 初始化信号量
+     * @param sem 信号量
+     * @param initial 初始计数
+     * @param max_count 最大计数（1为二值信号量，可作为事件使用）
+     */
+    void worker_sem_init(worker_sem_t *sem, uint32_t initial, uint32_t max_count);
+
+    /**
+     * @brief 释放信号量，唤醒最早等待的协程
+     * @return 0:成功 -1:已达到最大计数
+     */
+    int worker_sem_give(worker_sem_t *sem);
+
+    /**
+     * @brief 在中断中释放信号量
+     * @return 0:成功 -1:已达到最大计数
+     */
+    int worker_sem_give_from_isr(worker_sem_t *sem, BaseType_t *higher_prio_woken);
+
+    // 以下为宏内部使用
+    void worker_coro_wait_begin(worker_coro_t *co, uint32_t timeout_ms);
+    bool worker_coro_wait_expired(worker_coro_t *co);
+    void worker_coro_wait_end(worker_coro_t *co);
+    bool worker_coro_sem_poll(worker_coro_t *co, worker_sem_t *sem);
+    void worker_sem_cancel_wait(worker_sem_t *sem, worker_coro_t *co);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,6 @@
 #include "unity.h"
 #include "worker.h"
+#include "worker_coro.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
@@ -64,6 +65,15 @@ void normal_priority_work_callback(void *arg)
     }
 }
 
+void blocking_work_callback(void *arg)
+{
+    SemaphoreHandle_t sem = (SemaphoreHandle_t)arg;
+    if (sem)
+    {
+        xSemaphoreTake(sem, pdMS_TO_TICKS(1000));
+    }
+}
+
 // setUp和tearDown函数
 void setUp(void)
 {
@@ -206,6 +216,970 @@ void test_worker_batch_tasks(void)
     TEST_ASSERT_EQUAL_INT(task_count, counter);
 }
 
+// 测试用例：批量提交
+void test_worker_send_batch(void)
+{
+    int result = worker_thread_init(4, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    static int counter = 0;
+    counter = 0;
+
+    worker_queue_item_t items[6];
+    for (int i = 0; i < 6; i++)
+    {
+        items[i] = (worker_queue_item_t){
+            .cb = simple_work_callback,
+            .arg = &counter,
+            .flags = WORKER_FLAG_NONE,
+            .name = "batch_item"};
+    }
+
+    worker_suspend();
+
+    // 节点池只有4个，超出部分不放入
+    result = worker_send_batch(items, 6);
+    TEST_ASSERT_EQUAL_INT(4, result);
+    TEST_ASSERT_EQUAL_UINT32(4, worker_get_queue_length());
+    TEST_ASSERT_EQUAL_INT(0, worker_send_batch(items, 1));
+
+    worker_resume();
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_INT(4, counter);
+}
+
+// 测试用例：线程池工作窃取
+void test_worker_pool_work_stealing(void)
+{
+    int result = worker_pool_init(2, 10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_UINT32(2, worker_get_thread_num());
+
+    SemaphoreHandle_t block_sem = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(block_sem);
+
+    static int counter = 0;
+    counter = 0;
+
+    // 第一个任务阻塞其中一个线程
+    worker_queue_item_t block_item = {
+        .cb = blocking_work_callback,
+        .arg = block_sem,
+        .flags = WORKER_FLAG_NONE,
+        .name = "block_task"};
+    result = worker_send(&block_item);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    // 轮询分配的后续任务有一半排在阻塞线程之后，应被空闲线程窃取执行
+    for (int i = 0; i < 4; i++)
+    {
+        worker_queue_item_t item = {
+            .cb = simple_work_callback,
+            .arg = &counter,
+            .flags = WORKER_FLAG_NONE,
+            .name = "steal_task"};
+
+        result = worker_send(&item);
+        TEST_ASSERT_EQUAL_INT(0, result);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL_INT(4, counter);
+
+    // 释放阻塞任务后队列应能刷新完成
+    xSemaphoreGive(block_sem);
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    vSemaphoreDelete(block_sem);
+}
+
+// 测试用例：中断提交接口
+void test_worker_send_from_isr(void)
+{
+    int result = worker_thread_init(10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    g_test_data.value = 7;
+
+    worker_queue_item_t item = {
+        .cb = test_work_callback,
+        .arg = &g_test_data,
+        .flags = WORKER_FLAG_NONE,
+        .name = "isr_task"};
+
+    BaseType_t woken = pdFALSE;
+    result = worker_send_from_isr(&item, &woken);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    BaseType_t sem_result = xSemaphoreTake(g_test_sem, pdMS_TO_TICKS(1000));
+    TEST_ASSERT_EQUAL_INT(pdTRUE, sem_result);
+    TEST_ASSERT_TRUE(g_test_data.executed);
+}
+
+// 测试用例：中断提交缓冲区满
+void test_worker_send_from_isr_ring_full(void)
+{
+    int result = worker_thread_init(10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    static int counter = 0;
+    counter = 0;
+
+    worker_suspend();
+
+    worker_queue_item_t item = {
+        .cb = simple_work_callback,
+        .arg = &counter,
+        .flags = WORKER_FLAG_NONE,
+        .name = "isr_ring_task"};
+
+    // 缓冲区容量大于节点池，取出时需要分多次转入本地队列
+    for (int i = 0; i < WORKER_ISR_RING_SIZE; i++)
+    {
+        result = worker_send_from_isr(&item, NULL);
+        TEST_ASSERT_EQUAL_INT(0, result);
+    }
+
+    result = worker_send_from_isr(&item, NULL);
+    TEST_ASSERT_EQUAL_INT(-1, result);
+    TEST_ASSERT_EQUAL_UINT32(WORKER_ISR_RING_SIZE, worker_get_queue_length());
+
+    worker_resume();
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_INT(WORKER_ISR_RING_SIZE, counter);
+}
+
+// 测试用例：侵入式工作对象重复提交只执行一次
+void test_worker_queue_work_dedup(void)
+{
+    int result = worker_thread_init(10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    static int counter = 0;
+    static worker_work_t work = WORKER_WORK_INIT(simple_work_callback, &counter);
+    counter = 0;
+
+    worker_suspend();
+
+    TEST_ASSERT_EQUAL_INT(0, worker_queue_work(&work));
+    TEST_ASSERT_EQUAL_INT(1, worker_queue_work(&work));
+    TEST_ASSERT_EQUAL_INT(1, worker_queue_work_from_isr(&work, NULL));
+    TEST_ASSERT_TRUE(worker_work_is_pending(&work));
+    TEST_ASSERT_EQUAL_UINT32(1, worker_get_queue_length());
+
+    worker_resume();
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_INT(1, counter);
+    TEST_ASSERT_FALSE(worker_work_is_pending(&work));
+
+    // 执行完成后可以再次提交（中断路径）
+    TEST_ASSERT_EQUAL_INT(0, worker_queue_work_from_isr(&work, NULL));
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_INT(2, counter);
+}
+
+// 测试用例：延迟和周期工作
+void test_worker_send_delayed_periodic(void)
+{
+    int result = worker_thread_init(10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    static int delayed_counter = 0;
+    static int periodic_counter = 0;
+    static worker_timer_t delayed_timer = WORKER_TIMER_INIT(simple_work_callback, &delayed_counter);
+    static worker_timer_t periodic_timer = WORKER_TIMER_INIT(simple_work_callback, &periodic_counter);
+    delayed_counter = 0;
+    periodic_counter = 0;
+
+    TEST_ASSERT_EQUAL_INT(0, worker_send_delayed(&delayed_timer, 50));
+    TEST_ASSERT_EQUAL_INT(0, worker_send_periodic(&periodic_timer, 20));
+
+    vTaskDelay(pdMS_TO_TICKS(25));
+    TEST_ASSERT_EQUAL_INT(0, delayed_counter);
+
+    vTaskDelay(pdMS_TO_TICKS(85));
+    TEST_ASSERT_EQUAL_INT(1, delayed_counter);
+    TEST_ASSERT_INT_WITHIN(1, 5, periodic_counter);
+
+    // 取消后不再执行
+    TEST_ASSERT_EQUAL_INT(0, worker_timer_cancel(&periodic_timer));
+    TEST_ASSERT_EQUAL_INT(1, worker_timer_cancel(&periodic_timer));
+    worker_flush(100);
+    int snapshot = periodic_counter;
+    vTaskDelay(pdMS_TO_TICKS(60));
+    TEST_ASSERT_EQUAL_INT(snapshot, periodic_counter);
+}
+
+static volatile bool g_slow_done = false;
+
+static void slow_flag_callback(void *arg)
+{
+    (void)arg;
+    vTaskDelay(pdMS_TO_TICKS(50));
+    g_slow_done = true;
+}
+
+// 测试用例：一个线程执行慢回调时，定时对象由空闲线程按时处理
+void test_worker_timer_during_slow_callback(void)
+{
+    int result = worker_pool_init(2, 10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    static int delayed_counter = 0;
+    static worker_timer_t delayed_timer = WORKER_TIMER_INIT(simple_work_callback, &delayed_counter);
+    worker_queue_item_t slow = {
+        .cb = slow_flag_callback,
+        .arg = NULL,
+        .flags = WORKER_FLAG_NONE,
+        .name = "slow_task"};
+
+    // 外部提交轮流分给两个线程，两轮中各有一个线程被慢回调占用
+    for (int round = 0; round < 2; round++)
+    {
+        delayed_counter = 0;
+        g_slow_done = false;
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&slow));
+        vTaskDelay(pdMS_TO_TICKS(5));
+        TEST_ASSERT_EQUAL_INT(0, worker_send_delayed(&delayed_timer, 10));
+        vTaskDelay(pdMS_TO_TICKS(25));
+        TEST_ASSERT_EQUAL_INT(1, delayed_counter);
+        TEST_ASSERT_FALSE(g_slow_done);
+        TEST_ASSERT_EQUAL_INT(0, worker_flush(200));
+    }
+}
+
+// 记录执行顺序
+static int g_order_log[8];
+static int g_order_count = 0;
+
+static void order_log_callback(void *arg)
+{
+    if (g_order_count < (int)(sizeof(g_order_log) / sizeof(g_order_log[0])))
+    {
+        g_order_log[g_order_count++] = (int)(intptr_t)arg;
+    }
+}
+
+static void slow_order_log_callback(void *arg)
+{
+    vTaskDelay(pdMS_TO_TICKS(20));
+    order_log_callback(arg);
+}
+
+// 测试用例：优先级类别内先进先出，截止时间任务最早优先
+void test_worker_priority_classes_and_deadline(void)
+{
+    int result = worker_thread_init(10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    g_order_count = 0;
+    worker_suspend();
+
+    TickType_t now = xTaskGetTickCount();
+    const struct
+    {
+        int id;
+        uint8_t prio;
+        uint32_t flags;
+        TickType_t deadline;
+    } items[] = {
+        {1, WORKER_PRIO_LOW, WORKER_FLAG_NONE, 0},
+        {2, WORKER_PRIO_DEFAULT, WORKER_FLAG_HIGH_PRIO, 0},
+        {3, WORKER_PRIO_DEFAULT, WORKER_FLAG_HIGH_PRIO, 0},
+        {4, WORKER_PRIO_CRITICAL, WORKER_FLAG_NONE, 0},
+        {5, WORKER_PRIO_DEFAULT, WORKER_FLAG_NONE, 0},
+        {6, WORKER_PRIO_DEFAULT, WORKER_FLAG_DEADLINE, now + 500},
+        {7, WORKER_PRIO_DEFAULT, WORKER_FLAG_DEADLINE, now + 200},
+    };
+
+    for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++)
+    {
+        worker_queue_item_t item = {
+            .cb = order_log_callback,
+            .arg = (void *)(intptr_t)items[i].id,
+            .flags = items[i].flags,
+            .name = "order_task",
+            .deadline = items[i].deadline,
+            .prio = items[i].prio};
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&item));
+    }
+
+    worker_resume();
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    const int expected[] = {7, 6, 4, 2, 3, 5, 1};
+    TEST_ASSERT_EQUAL_INT(7, g_order_count);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, g_order_log, 7);
+    TEST_ASSERT_EQUAL_UINT32(0, worker_get_deadline_misses());
+
+    // 执行超过截止时间时计数
+    worker_queue_item_t late_item = {
+        .cb = slow_order_log_callback,
+        .arg = (void *)(intptr_t)8,
+        .flags = WORKER_FLAG_DEADLINE,
+        .name = "late_task",
+        .deadline = xTaskGetTickCount() + pdMS_TO_TICKS(5)};
+    TEST_ASSERT_EQUAL_INT(0, worker_send(&late_item));
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_UINT32(1, worker_get_deadline_misses());
+}
+
+// 测试用例：按名称统计执行剖析
+void test_worker_profile_stats(void)
+{
+    int result = worker_thread_init(10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    static int counter = 0;
+    counter = 0;
+    worker_profile_reset();
+
+    for (int i = 0; i < 5; i++)
+    {
+        worker_queue_item_t item = {
+            .cb = simple_work_callback,
+            .arg = &counter,
+            .flags = WORKER_FLAG_NONE,
+            .name = (i < 3) ? "prof_a" : "prof_b"};
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&item));
+    }
+    result = worker_flush(1000);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    worker_profile_entry_t entries[WORKER_PROFILE_SLOTS];
+    uint32_t n = worker_profile_get(entries, WORKER_PROFILE_SLOTS);
+    TEST_ASSERT_EQUAL_UINT32(2, n);
+    TEST_ASSERT_EQUAL_STRING("prof_a", entries[0].name);
+    TEST_ASSERT_EQUAL_UINT32(3, entries[0].count);
+    TEST_ASSERT_EQUAL_STRING("prof_b", entries[1].name);
+    TEST_ASSERT_EQUAL_UINT32(2, entries[1].count);
+    TEST_ASSERT_LESS_OR_EQUAL(entries[0].exec_max, entries[0].exec_min);
+
+    uint32_t hist_total = 0;
+    for (int i = 0; i < WORKER_PROFILE_HIST_BINS; i++)
+    {
+        hist_total += entries[0].exec_hist[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, hist_total);
+
+    static char dump[512];
+    int len = worker_profile_dump(dump, sizeof(dump));
+    TEST_ASSERT_GREATER_THAN(0, len);
+    TEST_ASSERT_NOT_NULL(strstr(dump, "name,count,"));
+    TEST_ASSERT_NOT_NULL(strstr(dump, "\nprof_a,3,"));
+    TEST_ASSERT_NOT_NULL(strstr(dump, "\nprof_b,2,"));
+
+    // 缓冲区不足时只保留完整的行
+    len = worker_profile_dump(dump, 120);
+    TEST_ASSERT_LESS_THAN(120, len);
+    TEST_ASSERT_EQUAL_INT('\n', dump[len - 1]);
+
+    // 内容相同的名称计入同一项，表满后的名称合并到"<other>"
+    worker_profile_reset();
+    static char names[WORKER_PROFILE_SLOTS + 3][8];
+    for (int i = 0; i < WORKER_PROFILE_SLOTS + 3; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "p%d", (i == WORKER_PROFILE_SLOTS + 2) ? 0 : i);
+        worker_queue_item_t item = {
+            .cb = simple_work_callback,
+            .arg = &counter,
+            .flags = WORKER_FLAG_NONE,
+            .name = names[i]};
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&item));
+        TEST_ASSERT_EQUAL_INT(0, worker_flush(1000));
+    }
+    n = worker_profile_get(entries, WORKER_PROFILE_SLOTS);
+    TEST_ASSERT_EQUAL_UINT32(WORKER_PROFILE_SLOTS, n);
+    TEST_ASSERT_EQUAL_STRING("p0", entries[0].name);
+    TEST_ASSERT_EQUAL_UINT32(2, entries[0].count);
+    TEST_ASSERT_EQUAL_STRING("<other>", entries[WORKER_PROFILE_SLOTS - 1].name);
+    TEST_ASSERT_EQUAL_UINT32(3, entries[WORKER_PROFILE_SLOTS - 1].count);
+}
+
+// 测试用例：完成句柄
+void test_worker_future(void)
+{
+    int result = worker_thread_init(10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    static worker_future_t future = WORKER_FUTURE_INIT;
+    TEST_ASSERT_EQUAL_INT(WORKER_FUTURE_IDLE, worker_future_poll(&future));
+    TEST_ASSERT_EQUAL_INT(-2, worker_future_wait(&future, 10));
+
+    g_slow_done = false;
+    worker_queue_item_t item = {
+        .cb = slow_flag_callback,
+        .arg = NULL,
+        .flags = WORKER_FLAG_NONE,
+        .name = "future_task",
+        .future = &future};
+    result = worker_send(&item);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_INT(WORKER_FUTURE_PENDING, worker_future_poll(&future));
+
+    // 超时后future仍在等待，回调返回后变为完成；调用任务默认通知上的计数不被取走
+    xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+    TEST_ASSERT_EQUAL_INT(-1, worker_future_wait(&future, 5));
+    TEST_ASSERT_EQUAL_INT(0, worker_future_wait(&future, 1000));
+    TEST_ASSERT_TRUE(g_slow_done);
+    TEST_ASSERT_EQUAL_INT(WORKER_FUTURE_DONE, worker_future_poll(&future));
+    TEST_ASSERT_EQUAL_UINT32(1, ulTaskNotifyTake(pdTRUE, 0));
+
+    // 排在后面未执行的工作项在销毁时被取消
+    static worker_future_t cancelled = WORKER_FUTURE_INIT;
+    worker_queue_item_t tail = {
+        .cb = simple_work_callback,
+        .arg = NULL,
+        .flags = WORKER_FLAG_NONE,
+        .name = "cancel_task",
+        .future = &cancelled};
+    TEST_ASSERT_EQUAL_INT(0, worker_send(&item));
+    vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_EQUAL_INT(0, worker_send(&tail));
+    TEST_ASSERT_EQUAL_INT(0, worker_thread_destroy());
+    TEST_ASSERT_EQUAL_INT(WORKER_FUTURE_DONE, worker_future_poll(&future));
+    TEST_ASSERT_EQUAL_INT(-3, worker_future_wait(&cancelled, 0));
+}
+
+static worker_work_t g_feed_work;
+static volatile bool g_feed_stop = false;
+static volatile int g_feed_count = 0;
+
+static void feed_callback(void *arg)
+{
+    (void)arg;
+    g_feed_count++;
+    vTaskDelay(pdMS_TO_TICKS(1));
+    if (!g_feed_stop)
+    {
+        worker_queue_work(&g_feed_work);
+    }
+}
+
+// 测试用例：刷新只等待调用前提交的工作项
+void test_worker_flush_epoch(void)
+{
+    int result = worker_pool_init(2, 10, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+
+    // 正在执行的工作项完成后才返回
+    g_slow_done = false;
+    worker_queue_item_t slow = {
+        .cb = slow_flag_callback,
+        .arg = NULL,
+        .flags = WORKER_FLAG_NONE,
+        .name = "slow_task"};
+    TEST_ASSERT_EQUAL_INT(0, worker_send(&slow));
+    vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_EQUAL_INT(0, worker_flush(1000));
+    TEST_ASSERT_TRUE(g_slow_done);
+
+    // 持续有新任务提交时队列从不为空，刷新仍能完成
+    g_feed_stop = false;
+    g_feed_count = 0;
+    worker_work_init(&g_feed_work, feed_callback, NULL, "feed_task");
+    TEST_ASSERT_EQUAL_INT(0, worker_queue_work(&g_feed_work));
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    TEST_ASSERT_EQUAL_INT(0, worker_flush(200));
+    TEST_ASSERT_EQUAL_INT(0, worker_flush(200));
+    int fed = g_feed_count;
+    vTaskDelay(pdMS_TO_TICKS(20));
+    TEST_ASSERT_GREATER_THAN(fed, g_feed_count);
+
+    g_feed_stop = true;
+    TEST_ASSERT_EQUAL_INT(0, worker_flush(1000));
+    TEST_ASSERT_FALSE(worker_work_is_pending(&g_feed_work));
+}
+
+static void *g_dropped_arg = NULL;
+
+static void drop_record_callback(const worker_queue_item_t *item)
+{
+    g_dropped_arg = item->arg;
+}
+
+// 测试用例：队列满时的处理策略和计数
+void test_worker_overflow_policies(void)
+{
+    int result = worker_thread_init(3, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_INT(0, worker_set_drop_callback(drop_record_callback));
+    g_dropped_arg = NULL;
+
+    SemaphoreHandle_t block_sem = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(block_sem);
+
+    // 阻塞唯一的工作线程，再填满3个节点
+    worker_queue_item_t block_item = {
+        .cb = blocking_work_callback,
+        .arg = block_sem,
+        .flags = WORKER_FLAG_NONE,
+        .name = "block_task"};
+    TEST_ASSERT_EQUAL_INT(0, worker_send(&block_item));
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    static int counters[4];
+    memset(counters, 0, sizeof(counters));
+    static worker_future_t first_future = WORKER_FUTURE_INIT;
+    for (int i = 0; i < 3; i++)
+    {
+        worker_queue_item_t item = {
+            .cb = simple_work_callback,
+            .arg = &counters[i],
+            .flags = WORKER_FLAG_NONE,
+            .name = "fill_task",
+            .future = (i == 0) ? &first_future : NULL};
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&item));
+    }
+
+    // 默认策略：拒绝
+    worker_queue_item_t extra = {
+        .cb = simple_work_callback,
+        .arg = &counters[3],
+        .flags = WORKER_FLAG_NONE,
+        .name = "extra_task"};
+    TEST_ASSERT_EQUAL_INT(-1, worker_send(&extra));
+
+    // 合并：队列中有相同回调时返回1，没有时仍然失败
+    extra.overflow = WORKER_OVERFLOW_COALESCE;
+    TEST_ASSERT_EQUAL_INT(1, worker_send(&extra));
+    extra.cb = test_work_callback;
+    TEST_ASSERT_EQUAL_INT(-1, worker_send(&extra));
+    extra.cb = simple_work_callback;
+
+    // 带future的工作项不合并，future保持空闲
+    static worker_future_t extra_future = WORKER_FUTURE_INIT;
+    extra.future = &extra_future;
+    TEST_ASSERT_EQUAL_INT(-1, worker_send(&extra));
+    TEST_ASSERT_EQUAL_INT(WORKER_FUTURE_IDLE, worker_future_poll(&extra_future));
+    extra.future = NULL;
+
+    // 丢弃最旧：低优先级的新项不能挤出普通优先级的工作项
+    extra.overflow = WORKER_OVERFLOW_DROP_OLDEST;
+    extra.prio = WORKER_PRIO_LOW;
+    TEST_ASSERT_EQUAL_INT(-1, worker_send(&extra));
+    TEST_ASSERT_NULL(g_dropped_arg);
+
+    extra.prio = WORKER_PRIO_DEFAULT;
+    TEST_ASSERT_EQUAL_INT(0, worker_send(&extra));
+    TEST_ASSERT_EQUAL_PTR(&counters[0], g_dropped_arg);
+    TEST_ASSERT_EQUAL_INT(WORKER_FUTURE_CANCELLED, worker_future_poll(&first_future));
+
+    // 阻塞等待：超时后失败
+    TEST_ASSERT_EQUAL_INT(0, worker_set_overflow_policy(WORKER_OVERFLOW_BLOCK, 30));
+    extra.overflow = WORKER_OVERFLOW_DEFAULT;
+    TickType_t start = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL_INT(-1, worker_send(&extra));
+    TEST_ASSERT_GREATER_OR_EQUAL(pdMS_TO_TICKS(30), xTaskGetTickCount() - start);
+
+    worker_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, worker_get_stats(&stats));
+    TEST_ASSERT_EQUAL_UINT32(5, stats.accepted);
+    TEST_ASSERT_EQUAL_UINT32(6, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.coalesced);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.high_water);
+
+    xSemaphoreGive(block_sem);
+    TEST_ASSERT_EQUAL_INT(0, worker_flush(1000));
+    TEST_ASSERT_EQUAL_INT(0, counters[0]);
+    TEST_ASSERT_EQUAL_INT(1, counters[1]);
+    TEST_ASSERT_EQUAL_INT(1, counters[2]);
+    TEST_ASSERT_EQUAL_INT(1, counters[3]);
+
+    vSemaphoreDelete(block_sem);
+}
+
+// 测试用例：丢弃最旧按提交顺序选择，与性能统计无关（WORKER_PROFILE_ENABLE=0时也成立）
+void test_worker_drop_oldest_order(void)
+{
+    int result = worker_pool_init(2, 3, 1024, 5);
+    TEST_ASSERT_EQUAL_INT(0, result);
+    TEST_ASSERT_EQUAL_INT(0, worker_set_drop_callback(drop_record_callback));
+
+    // 阻塞两个工作线程，填满的节点按轮询分到两个线程的队列中
+    SemaphoreHandle_t block_sems[2];
+    for (int i = 0; i < 2; i++)
+    {
+        block_sems[i] = xSemaphoreCreateBinary();
+        TEST_ASSERT_NOT_NULL(block_sems[i]);
+        worker_queue_item_t block_item = {
+            .cb = blocking_work_callback,
+            .arg = block_sems[i],
+            .flags = WORKER_FLAG_NONE,
+            .name = "block_task"};
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&block_item));
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    static int counters[5];
+    memset(counters, 0, sizeof(counters));
+    for (int i = 0; i < 3; i++)
+    {
+        worker_queue_item_t item = {
+            .cb = simple_work_callback,
+            .arg = &counters[i],
+            .flags = WORKER_FLAG_NONE,
+            .name = "fill_task"};
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&item));
+    }
+
+    // 每次挤出的都是最早提交的，而不是第一个线程队首的工作项
+    for (int i = 3; i < 5; i++)
+    {
+        g_dropped_arg = NULL;
+        worker_queue_item_t item = {
+            .cb = simple_work_callback,
+            .arg = &counters[i],
+            .flags = WORKER_FLAG_NONE,
+            .name = "new_task",
+            .overflow = WORKER_OVERFLOW_DROP_OLDEST};
+        TEST_ASSERT_EQUAL_INT(0, worker_send(&item));
+        TEST_ASSERT_EQUAL_PTR(&counters[i - 3], g_dropped_arg);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        xSemaphoreGive(block_sems[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(0, worker_flush(1000));
+    TEST_ASSERT_EQUAL_INT(0, counters[0]);
+    TEST_ASSERT_EQUAL_INT(0, counters[1]);
+    TEST_ASSERT_EQUAL_INT(1, counters[2]);
+    TEST_ASSERT_EQUAL_INT(1, counters[3]);
+    TEST_ASSERT_EQUAL_INT(1, counters[4]);
+
+    for (int i = 0; i < 2; i++)
+    {
+        vSemaphoreDelete(block_sems[i]);
+    }
+}
+
+// 测试创建的工作队列的存储（静态分配模式使用，动态模式下忽略）
+WORKER_STATIC_STORAGE(test_wq_a, 2, 8, 1024);
+WORKER_STATIC_STORAGE(test_wq_b, 1, 8, 1024);
+
+// 测试用例：多个独立工作队列
+void test_worker_multiple_workqueues(void)
+{
+    worker_config_t io_config = {
+        .name = "io_wq",
+        .thread_num = 1,
+        .item_num = 4,
+        .stack_size = 1024,
+        .priority = 6,
+        .nodes = test_wq_a_nodes,
+        .stacks = test_wq_a_stacks};
+    worker_config_t bulk_config = {
+        .name = "bulk_wq",
+        .thread_num = 1,
+        .item_num = 8,
+        .stack_size = 1024,
+        .priority = 3,
+        .nodes = test_wq_b_nodes,
+        .stacks = test_wq_b_stacks};
+
+    worker_t *io_wq = workqueue_create(&io_config);
+    worker_t *bulk_wq = workqueue_create(&bulk_config);
+    TEST_ASSERT_NOT_NULL(io_wq);
+    TEST_ASSERT_NOT_NULL(bulk_wq);
+
+    // 名称唯一，可按名称查找
+    TEST_ASSERT_NULL(workqueue_create(&io_config));
+    TEST_ASSERT_EQUAL_PTR(io_wq, workqueue_find("io_wq"));
+    TEST_ASSERT_EQUAL_PTR(bulk_wq, workqueue_find("bulk_wq"));
+    TEST_ASSERT_NULL(workqueue_get_default());
+
+    SemaphoreHandle_t block_sem = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(block_sem);
+
+    static int counter = 0;
+    counter = 0;
+
+    // 批量队列被阻塞时，I/O队列的任务照常执行
+    worker_queue_item_t block_item = {
+        .cb = blocking_work_callback,
+        .arg = block_sem,
+        .flags = WORKER_FLAG_NONE,
+        .name = "bulk_block"};
+    TEST_ASSERT_EQUAL_INT(0, workqueue_send(bulk_wq, &block_item));
+
+    worker_queue_item_t io_item = {
+        .cb = simple_work_callback,
+        .arg = &counter,
+        .flags = WORKER_FLAG_NONE,
+        .name = "io_task"};
+    for (int i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(0, workqueue_send(io_wq, &io_item));
+    }
+    TEST_ASSERT_EQUAL_INT(0, workqueue_flush(io_wq, 200));
+    TEST_ASSERT_EQUAL_INT(3, counter);
+    TEST_ASSERT_EQUAL_INT(-1, workqueue_flush(bulk_wq, 20));
+
+    // 各队列的深度和统计相互独立
+    worker_stats_t io_stats;
+    worker_stats_t bulk_stats;
+    TEST_ASSERT_EQUAL_INT(0, workqueue_get_stats(io_wq, &io_stats));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_get_stats(bulk_wq, &bulk_stats));
+    TEST_ASSERT_EQUAL_UINT32(4, io_stats.item_num);
+    TEST_ASSERT_EQUAL_UINT32(8, bulk_stats.item_num);
+    TEST_ASSERT_EQUAL_UINT32(3, io_stats.executed);
+    TEST_ASSERT_EQUAL_UINT32(0, bulk_stats.executed);
+
+    // 默认队列未初始化时旧接口返回错误，不影响其他队列
+    TEST_ASSERT_EQUAL_INT(-1, worker_send(&io_item));
+
+    xSemaphoreGive(block_sem);
+    TEST_ASSERT_EQUAL_INT(0, workqueue_flush(bulk_wq, 1000));
+
+    TEST_ASSERT_EQUAL_INT(0, workqueue_delete(io_wq));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_delete(bulk_wq));
+    TEST_ASSERT_NULL(workqueue_find("io_wq"));
+
+    vSemaphoreDelete(block_sem);
+}
+
+// 协程测试上下文（跨等待的状态保存在这里）
+typedef struct
+{
+    worker_sem_t *sem;
+    volatile bool event;
+    int steps;
+    bool delay_ok;
+    bool wait_timed_out;
+    bool sem_timed_out;
+    TickType_t start;
+} coro_test_ctx_t;
+
+static int coro_test_flow(worker_coro_t *co, void *arg)
+{
+    coro_test_ctx_t *ctx = (coro_test_ctx_t *)arg;
+
+    WORKER_CORO_BEGIN(co);
+
+    // 让出
+    for (ctx->steps = 0; ctx->steps < 3;)
+    {
+        ctx->steps++;
+        WORKER_CORO_YIELD(co);
+    }
+
+    // 延迟
+    ctx->start = xTaskGetTickCount();
+    WORKER_CORO_DELAY(co, 20);
+    ctx->delay_ok = (xTaskGetTickCount() - ctx->start) >= pdMS_TO_TICKS(20);
+
+    // 等待条件超时
+    WORKER_CORO_WAIT_UNTIL(co, ctx->event, 30);
+    ctx->wait_timed_out = worker_coro_timed_out(co);
+
+    // 信号量
+    WORKER_CORO_SEM_TAKE(co, ctx->sem, 1000);
+    ctx->sem_timed_out = worker_coro_timed_out(co);
+
+    // 中断唤醒的事件
+    WORKER_CORO_WAIT_UNTIL(co, ctx->event, WORKER_CORO_FOREVER);
+
+    WORKER_CORO_END(co);
+}
+
+static int coro_sem_waiter(worker_coro_t *co, void *arg)
+{
+    WORKER_CORO_BEGIN(co);
+    WORKER_CORO_SEM_TAKE(co, (worker_sem_t *)arg, 1000);
+    if (worker_coro_timed_out(co))
+    {
+        WORKER_CORO_EXIT(co);
+    }
+    __atomic_fetch_add(&g_callback_count, 1, __ATOMIC_RELAXED);
+    WORKER_CORO_END(co);
+}
+
+static bool coro_wait_done(worker_coro_t *co, uint32_t timeout_ms)
+{
+    for (uint32_t t = 0; t < timeout_ms; t += 5)
+    {
+        if (worker_coro_get_state(co) == WORKER_CORO_DONE)
+        {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    return worker_coro_get_state(co) == WORKER_CORO_DONE;
+}
+
+// 测试用例：无栈协程工作项
+void test_worker_coroutine(void)
+{
+    worker_config_t config = {
+        .name = "coro_wq",
+        .thread_num = 2,
+        .item_num = 8,
+        .stack_size = 1024,
+        .priority = 5,
+        .nodes = test_wq_a_nodes,
+        .stacks = test_wq_a_stacks};
+    worker_t *wq = workqueue_create(&config);
+    TEST_ASSERT_NOT_NULL(wq);
+
+    static worker_sem_t sem;
+    static coro_test_ctx_t ctx;
+    static worker_coro_t co;
+    worker_sem_init(&sem, 0, 1);
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.sem = &sem;
+
+    worker_coro_init(&co, coro_test_flow, &ctx, "coro_flow");
+    TEST_ASSERT_EQUAL_INT(WORKER_CORO_IDLE, worker_coro_get_state(&co));
+    TEST_ASSERT_EQUAL_INT(-1, worker_coro_wake(&co));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_coro_start(wq, &co));
+    TEST_ASSERT_EQUAL_INT(-1, workqueue_coro_start(wq, &co));
+
+    // 让出、延迟和条件等待超时后停在信号量上
+    vTaskDelay(pdMS_TO_TICKS(150));
+    TEST_ASSERT_EQUAL_INT(3, ctx.steps);
+    TEST_ASSERT_TRUE(ctx.delay_ok);
+    TEST_ASSERT_TRUE(ctx.wait_timed_out);
+    TEST_ASSERT_EQUAL_INT(WORKER_CORO_RUNNING, worker_coro_get_state(&co));
+
+    TEST_ASSERT_EQUAL_INT(0, worker_sem_give(&sem));
+    vTaskDelay(pdMS_TO_TICKS(20));
+    TEST_ASSERT_FALSE(ctx.sem_timed_out);
+    TEST_ASSERT_EQUAL_UINT32(0, sem.count);
+    TEST_ASSERT_EQUAL_INT(0, worker_sem_give(&sem));
+    TEST_ASSERT_EQUAL_INT(-1, worker_sem_give(&sem));
+    TEST_ASSERT_EQUAL_INT(WORKER_CORO_RUNNING, worker_coro_get_state(&co));
+
+    // 中断中置位事件并唤醒
+    BaseType_t woken = pdFALSE;
+    ctx.event = true;
+    TEST_ASSERT_GREATER_OR_EQUAL(0, worker_coro_wake_from_isr(&co, &woken));
+    TEST_ASSERT_TRUE(coro_wait_done(&co, 200));
+    TEST_ASSERT_EQUAL_INT(-1, worker_coro_wake(&co));
+
+    // 多个协程先进先出等待同一个计数信号量，共用两个工作线程
+    static worker_coro_t waiters[8];
+    g_callback_count = 0;
+    worker_sem_init(&sem, 0, 8);
+    for (int i = 0; i < 8; i++)
+    {
+        worker_coro_init(&waiters[i], coro_sem_waiter, &sem, "coro_waiter");
+        TEST_ASSERT_EQUAL_INT(0, workqueue_coro_start(wq, &waiters[i]));
+    }
+    vTaskDelay(pdMS_TO_TICKS(20));
+    TEST_ASSERT_EQUAL_INT(0, g_callback_count);
+
+    for (int i = 0; i < 8; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(0, worker_sem_give(&sem));
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        TEST_ASSERT_TRUE(coro_wait_done(&waiters[i], 200));
+    }
+    TEST_ASSERT_EQUAL_INT(8, g_callback_count);
+    TEST_ASSERT_EQUAL_UINT32(0, sem.count);
+
+    // 取消等待中的协程后释放信号量不会唤醒它
+    worker_coro_init(&waiters[0], coro_sem_waiter, &sem, "coro_waiter");
+    TEST_ASSERT_EQUAL_INT(0, workqueue_coro_start(wq, &waiters[0]));
+    vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_EQUAL_INT(0, worker_coro_cancel(&waiters[0]));
+    TEST_ASSERT_NULL(sem.waiters);
+    TEST_ASSERT_EQUAL_INT(0, worker_sem_give(&sem));
+    vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_EQUAL_INT(8, g_callback_count);
+    TEST_ASSERT_EQUAL_UINT32(1, sem.count);
+
+    TEST_ASSERT_EQUAL_INT(0, workqueue_delete(wq));
+}
+
+// 忙等待指定毫秒（计入忙碌时间）
+static void busy_spin_callback(void *arg)
+{
+    TickType_t start = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS((uint32_t)(uintptr_t)arg))
+    {
+    }
+}
+
+// 测试用例：事件驱动的线程循环和忙碌/空闲统计
+void test_worker_idle_accounting(void)
+{
+    worker_config_t config = {
+        .name = "idle_wq",
+        .thread_num = 2,
+        .item_num = 8,
+        .stack_size = 1024,
+        .priority = 5,
+        .nodes = test_wq_a_nodes,
+        .stacks = test_wq_a_stacks};
+    worker_t *wq = workqueue_create(&config);
+    TEST_ASSERT_NOT_NULL(wq);
+
+    // 空闲且没有定时对象时线程不会醒来
+    vTaskDelay(pdMS_TO_TICKS(200));
+    worker_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, workqueue_get_stats(wq, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.wakeups);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.busy_ms);
+    TEST_ASSERT_GREATER_OR_EQUAL(2 * 190, stats.idle_ms);
+
+    // 执行工作项计入忙碌时间
+    worker_queue_item_t spin_item = {
+        .cb = busy_spin_callback,
+        .arg = (void *)(uintptr_t)30,
+        .flags = WORKER_FLAG_NONE,
+        .name = "busy_spin"};
+    TEST_ASSERT_EQUAL_INT(0, workqueue_send(wq, &spin_item));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_flush(wq, 500));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_get_stats(wq, &stats));
+    TEST_ASSERT_GREATER_OR_EQUAL(1, stats.wakeups);
+    TEST_ASSERT_GREATER_OR_EQUAL(25, stats.busy_ms);
+    TEST_ASSERT_TRUE(stats.busy_ms < 100);
+
+    // 暂停等待正在执行的工作项完成，暂停期间提交的工作项不执行
+    g_slow_done = false;
+    worker_queue_item_t slow_item = {
+        .cb = slow_flag_callback,
+        .arg = NULL,
+        .flags = WORKER_FLAG_NONE,
+        .name = "slow_flag"};
+    TEST_ASSERT_EQUAL_INT(0, workqueue_send(wq, &slow_item));
+    vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_suspend(wq));
+    TEST_ASSERT_TRUE(g_slow_done);
+    TEST_ASSERT_EQUAL_INT(WORKER_STATE_SUSPENDED, workqueue_get_state(wq));
+
+    static int counter = 0;
+    counter = 0;
+    worker_queue_item_t item = {
+        .cb = simple_work_callback,
+        .arg = &counter,
+        .flags = WORKER_FLAG_NONE,
+        .name = "suspended"};
+    TEST_ASSERT_EQUAL_INT(0, workqueue_send(wq, &item));
+    vTaskDelay(pdMS_TO_TICKS(30));
+    TEST_ASSERT_EQUAL_INT(0, counter);
+    TEST_ASSERT_EQUAL_UINT32(1, workqueue_get_queue_length(wq));
+
+    TEST_ASSERT_EQUAL_INT(0, workqueue_resume(wq));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_flush(wq, 200));
+    TEST_ASSERT_EQUAL_INT(1, counter);
+
+    // 暂停中直接删除，线程响应关闭消息退出
+    TEST_ASSERT_EQUAL_INT(0, workqueue_suspend(wq));
+    TEST_ASSERT_EQUAL_INT(0, workqueue_delete(wq));
+}
+
 // 测试用例：Worker状态管理
 void test_worker_state_management(void)
 {
@@ -299,6 +1273,24 @@ void worker_test_runner(void)
     // 高级功能测试
     RUN_TEST(test_worker_high_priority_task);
     RUN_TEST(test_worker_batch_tasks);
+    RUN_TEST(test_worker_send_batch);
+    RUN_TEST(test_worker_pool_work_stealing);
+    RUN_TEST(test_worker_send_from_isr);
+    RUN_TEST(test_worker_send_from_isr_ring_full);
+    RUN_TEST(test_worker_queue_work_dedup);
+    RUN_TEST(test_worker_send_delayed_periodic);
+    RUN_TEST(test_worker_timer_during_slow_callback);
+    RUN_TEST(test_worker_priority_classes_and_deadline);
+#if WORKER_PROFILE_ENABLE
+    RUN_TEST(test_worker_profile_stats);
+#endif
+    RUN_TEST(test_worker_future);
+    RUN_TEST(test_worker_flush_epoch);
+    RUN_TEST(test_worker_overflow_policies);
+    RUN_TEST(test_worker_drop_oldest_order);
+    RUN_TEST(test_worker_multiple_workqueues);
+    RUN_TEST(test_worker_coroutine);
+    RUN_TEST(test_worker_idle_accounting);
 
     // 状态管理测试
     RUN_TEST(test_worker_state_management);
@@ -5,327 +5,2841 @@
 #include "semphr.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdbool.h>
+#if WORKER_PROFILE_ENABLE
+#include "compile.h"
+#endif
 
 // 内部配置
 #define WORKER_TASK_NAME "WorkerThread"
+#define WORKER_DEFAULT_NAME "default" // 默认工作队列名称
 #define WORKER_MAGIC 0x574B // "WK" 魔数
 
-// Worker内部控制结构
+#define WORKER_ISR_RING_MASK (WORKER_ISR_RING_SIZE - 1)
+#if (WORKER_ISR_RING_SIZE & WORKER_ISR_RING_MASK) != 0
+#error "WORKER_ISR_RING_SIZE must be a power of 2"
+#endif
+
+#define WORKER_TIMER_WHEEL_MASK (WORKER_TIMER_WHEEL_SIZE - 1)
+#if (WORKER_TIMER_WHEEL_SIZE & WORKER_TIMER_WHEEL_MASK) != 0
+#error "WORKER_TIMER_WHEEL_SIZE must be a power of 2"
+#endif
+
+#if WORKER_FUTURE_NOTIFY_INDEX < 1 || configTASK_NOTIFICATION_ARRAY_ENTRIES <= WORKER_FUTURE_NOTIFY_INDEX
+#error "worker_future_wait needs configTASK_NOTIFICATION_ARRAY_ENTRIES > WORKER_FUTURE_NOTIFY_INDEX (>= 1)"
+#endif
+
+#if WORKER_PROFILE_ENABLE
+#define WORKER_STAMP() dwt_get_cycles()
+#else
+#define WORKER_STAMP() 0
+#endif
+
+// 工作对象状态位
+#define WORK_STATE_PENDING 0x01 // 已在队列中
+#define WORK_STATE_POOLED 0x02  // 属于节点池（worker_send复制的工作项）
+#define WORK_STATE_EPOCH 0x04   // 提交时所属的刷新纪元（0/1）
+
+// 控制消息（置位后通知所有工作线程，线程在两批工作项之间处理）
+#define WORKER_CTRL_SHUTDOWN 0x01 // 退出
+#define WORKER_CTRL_SUSPEND 0x02  // 暂停（线程停在等待通知处，不再取工作项）
+
+// 忙碌时间计时：启用剖析时使用DWT周期，否则使用tick
+#if WORKER_PROFILE_ENABLE
+#define WORKER_BUSY_CLOCK() dwt_get_cycles()
+#else
+#define WORKER_BUSY_CLOCK() ((uint32_t)xTaskGetTickCount())
+#endif
+
+// 工作队列（先进先出），节点池中的节点和调用者的侵入式工作对象链入同一队列
+typedef struct
+{
+    worker_work_t *head;
+    worker_work_t *tail;
+    uint32_t count;
+} worker_deque_t;
+
+// 取出待执行的工作项
+typedef struct
+{
+    worker_queue_item_t item;
+    uint32_t stamp; // 提交时间（DWT周期）
+    uint8_t epoch;  // 提交时所属的刷新纪元
+} worker_exec_t;
+
+// 中断提交环形缓冲区槽位
+typedef struct
+{
+    volatile uint32_t seq; // 序号：等于槽位位置时可写，等于位置+1时可读
+    uint32_t stamp;        // 提交时间（DWT周期）
+    uint8_t epoch;         // 提交时所属的刷新纪元
+    worker_queue_item_t item;
+} worker_isr_slot_t;
+
+// 无锁多生产者环形缓冲区（中断中提交，工作线程取出）
+typedef struct
+{
+    worker_isr_slot_t slots[WORKER_ISR_RING_SIZE];
+    volatile uint32_t enqueue_pos;
+    volatile uint32_t dequeue_pos;
+} worker_isr_ring_t;
+
+// 单个工作线程
+typedef struct
+{
+    TaskHandle_t task_handle;                      // 线程句柄
+    worker_deque_t queues[WORKER_PRIO_CLASS_NUM]; // 本地工作队列（每个优先级类别一个）
+    uint32_t queued;                               // 本地队列中的工作项数
+    volatile bool busy;                            // 正在执行工作项
+    uint32_t executed;        // 已执行的工作项数
+    uint32_t stolen;          // 从其他线程窃取的工作项数
+    uint32_t wakeups;         // 从等待中被唤醒的次数
+    uint64_t busy_time;       // 执行工作项的累计时间（WORKER_BUSY_CLOCK单位）
+    uint8_t index;            // 在线程池中的序号
+    struct worker *wq;        // 所属工作队列
+#if WORKER_STATIC_ALLOC
+    StaticTask_t tcb; // 线程控制块
+#endif
+} worker_thread_t;
+
+// 工作队列控制结构（worker_t）
+struct worker
+{
+    struct worker *next; // 工作队列链表
+    const char *name;    // 工作队列名称
+    bool is_static;      // 控制结构为静态存储（默认实例），删除时不释放
+
+    worker_thread_t threads[WORKER_POOL_MAX]; // 工作线程
+    uint8_t thread_num;                       // 工作线程数量
+    uint8_t next_thread;                      // 外部提交的轮询目标
+    volatile uint8_t running_threads;         // 尚未退出的线程数
+
+    worker_work_t *nodes;     // 节点池
+    worker_work_t *free_list; // 空闲节点链表
+    uint32_t item_num;        // 节点总数（队列深度）
+    uint32_t pending;         // 所有本地队列中等待的工作项数
+    uint32_t active;          // 正在执行的工作项数
+    uint32_t space_waiters;   // 等待空闲节点的提交者数量
+    uint32_t submit_seq;      // 节点池工作项的提交序号（单调递增，临界区内分配）
+
+    uint8_t overflow;          // 队列满时的处理策略
+    uint32_t block_timeout_ms; // BLOCK策略的最长等待时间
+    worker_drop_cb_t drop_cb;  // 工作项被挤出时的回调
+
+    uint32_t high_water;         // 等待工作项数的历史最大值
+    volatile uint32_t accepted;  // 已接受的提交数
+    volatile uint32_t dropped;   // 丢弃的工作项数
+    uint32_t coalesced;          // 合并的提交数
+
+    worker_deque_t edf;       // 截止时间队列（按deadline升序，所有线程共享）
+    uint32_t deadline_missed; // 错过截止时间的次数
+
+    worker_isr_ring_t isr_ring; // 中断提交缓冲区
+    uint32_t isr_dropped;       // 中断提交因缓冲区满而丢弃的数量
+
+    worker_work_t *volatile isr_works; // 中断提交的侵入式工作对象（无锁栈）
+    volatile uint32_t isr_work_count;  // isr_works中的对象数
+
+    // 哈希时间轮（任一线程持有wheel_lock时处理，槽号为到期tick取模，同槽内无序）
+    worker_timer_t *wheel[WORKER_TIMER_WHEEL_SIZE];
+    TickType_t wheel_tick;               // 下一个待处理的tick
+    uint32_t timer_count;                // 时间轮上的定时对象数
+    volatile uint8_t wheel_lock;         // 正在处理时间轮（尝试锁，拿不到的线程跳过）
+    worker_thread_t *volatile wheel_keeper; // 等待最近到期时间的空闲线程（NULL表示没有）
+
+    // 刷新纪元：每个工作项提交时计入当前纪元，执行完毕后减去；
+    // 刷新时切换纪元，只等待旧纪元清零，之后提交的工作项计入新纪元
+    volatile uint32_t inflight[2]; // 各纪元已接受但未执行完毕的工作项数
+    uint8_t epoch;                 // 当前纪元
+    uint8_t flush_epoch;           // 正在等待清零的纪元
+    bool flush_waiting;            // 有刷新者在等待flush_epoch清零
+    SemaphoreHandle_t flush_lock;  // 刷新者互斥锁
+
+    SemaphoreHandle_t flush_sem; // 刷新信号量
+    SemaphoreHandle_t space_sem; // 空闲节点信号量
+    SemaphoreHandle_t ctrl_sem;  // 控制消息应答（线程暂停或退出时释放）
+#if WORKER_STATIC_ALLOC
+    StaticSemaphore_t flush_sem_buf;
+    StaticSemaphore_t flush_lock_buf;
+    StaticSemaphore_t space_sem_buf;
+    StaticSemaphore_t ctrl_sem_buf;
+#endif
+
+    // 状态标志
+    uint16_t magic;                // 魔数，用于检查初始化状态
+    volatile worker_state_t state; // Worker状态
+    volatile uint8_t ctrl;         // 控制消息（WORKER_CTRL_*）
+    TickType_t start_tick;         // 创建时间（计算空闲时间）
+};
+
+// 默认工作队列（worker_send等无句柄接口使用）
+static worker_t g_default_worker = {
+    .magic = 0,
+    .state = WORKER_STATE_STOPPED,
+    .ctrl = 0};
+
+// 已创建的工作队列链表（按名称查找）
+static worker_t *g_worker_list = NULL;
+
+#if WORKER_STATIC_ALLOC
+// 默认工作队列的节点池和线程栈
+WORKER_STATIC_SECTION static worker_work_t g_default_nodes[WORKER_STATIC_ITEM_NUM];
+WORKER_STATIC_SECTION static StackType_t g_default_stacks[WORKER_STATIC_THREAD_NUM *
+                                                          (WORKER_STATIC_STACK_SIZE / sizeof(StackType_t))];
+
+// workqueue_create使用的控制块槽位
+static worker_t g_worker_blocks[WORKER_STATIC_QUEUE_NUM];
+static bool g_worker_block_used[WORKER_STATIC_QUEUE_NUM];
+#endif
+
+// 截止时间错过回调（不随worker初始化清除）
+static worker_deadline_miss_cb_t g_deadline_miss_cb = NULL;
+
+#if WORKER_PROFILE_ENABLE
+// 单个名称的剖析累计值（时间单位：DWT周期）
+typedef struct
+{
+    const char *name;
+    uint32_t count;
+    uint32_t exec_min;
+    uint32_t exec_max;
+    uint64_t exec_sum;
+    uint32_t wait_min;
+    uint32_t wait_max;
+    uint64_t wait_sum;
+    uint16_t exec_hist[WORKER_PROFILE_HIST_BINS];
+    uint16_t wait_hist[WORKER_PROFILE_HIST_BINS];
+} worker_profile_slot_t;
+
+// 剖析统计表（不随worker初始化清除，由worker_profile_reset清空）
+static struct
+{
+    worker_profile_slot_t slots[WORKER_PROFILE_SLOTS];
+    volatile uint32_t used;       // 已使用的表项数（表项名称写入后才增加）
+    volatile uint32_t generation; // 清空次数，清空后之前查到的表项下标失效
+    uint32_t cycles_per_us;       // 每微秒周期数
+} g_profile;
+#endif
+
+// =============================================================================
+// 内部辅助函数
+// =============================================================================
+
+/**
+ * @brief 执行工作项
+ */
+static void execute_work_item(const worker_queue_item_t *item)
+{
+    if (!item || !item->cb)
+    {
+        return;
+    }
+
+    // 执行工作回调
+    item->cb(item->arg);
+}
+
+static void deque_push_back(worker_deque_t *dq, worker_work_t *node)
+{
+    node->next = NULL;
+    if (dq->tail)
+    {
+        dq->tail->next = node;
+    }
+    else
+    {
+        dq->head = node;
+    }
+    dq->tail = node;
+    dq->count++;
+}
+
+/**
+ * @brief 按deadline升序插入，相同deadline保持提交顺序
+ */
+static void deque_insert_by_deadline(worker_deque_t *dq, worker_work_t *node)
+{
+    worker_work_t **pp = &dq->head;
+
+    while (*pp && (int32_t)((*pp)->item.deadline - node->item.deadline) <= 0)
+    {
+        pp = &(*pp)->next;
+    }
+    node->next = *pp;
+    *pp = node;
+    if (!node->next)
+    {
+        dq->tail = node;
+    }
+    dq->count++;
+}
+
+static worker_work_t *deque_pop_front(worker_deque_t *dq)
+{
+    worker_work_t *node = dq->head;
+    if (node)
+    {
+        dq->head = node->next;
+        if (!dq->head)
+        {
+            dq->tail = NULL;
+        }
+        dq->count--;
+    }
+    return node;
+}
+
+/**
+ * @brief 摘除队列中的节点
+ * @param prev 前一个节点（node为队首时为NULL）
+ */
+static void deque_remove(worker_deque_t *dq, worker_work_t *prev, worker_work_t *node)
+{
+    if (prev)
+    {
+        prev->next = node->next;
+    }
+    else
+    {
+        dq->head = node->next;
+    }
+    if (dq->tail == node)
+    {
+        dq->tail = prev;
+    }
+    node->next = NULL;
+    dq->count--;
+}
+
+static void isr_ring_reset(worker_isr_ring_t *ring)
+{
+    for (uint32_t i = 0; i < WORKER_ISR_RING_SIZE; i++)
+    {
+        ring->slots[i].seq = i;
+    }
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+}
+
+/**
+ * @brief 无锁写入中断提交缓冲区（可被更高优先级中断嵌套调用）
+ * @return true:成功 false:缓冲区满
+ */
+static bool isr_ring_push(worker_isr_ring_t *ring, const worker_queue_item_t *item, uint8_t epoch)
+{
+    uint32_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    worker_isr_slot_t *slot;
+
+    for (;;)
+    {
+        slot = &ring->slots[pos & WORKER_ISR_RING_MASK];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            // 槽位空闲，抢占写入位置
+            if (__atomic_compare_exchange_n(&ring->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; // 缓冲区满
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->item = *item;
+    slot->stamp = WORKER_STAMP();
+    slot->epoch = epoch;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief 从中断提交缓冲区取出一项
+ * @return true:取到 false:缓冲区空（或最早的槽位仍在写入中）
+ */
+static bool isr_ring_pop(worker_isr_ring_t *ring, worker_queue_item_t *out, uint32_t *stamp, uint8_t *epoch)
+{
+    uint32_t pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+    worker_isr_slot_t *slot;
+
+    for (;;)
+    {
+        slot = &ring->slots[pos & WORKER_ISR_RING_MASK];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring->dequeue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    *out = slot->item;
+    *stamp = slot->stamp;
+    *epoch = slot->epoch;
+    __atomic_store_n(&slot->seq, pos + WORKER_ISR_RING_SIZE, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool isr_ring_empty(const worker_isr_ring_t *ring)
+{
+    return __atomic_load_n(&ring->enqueue_pos, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&ring->dequeue_pos, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 无锁压入中断提交的工作对象
+ */
+static void isr_work_push(worker_t *w, worker_work_t *work)
+{
+    worker_work_t *head = __atomic_load_n(&w->isr_works, __ATOMIC_RELAXED);
+
+    __atomic_fetch_add(&w->isr_work_count, 1, __ATOMIC_RELAXED);
+    do
+    {
+        work->next = head;
+    } while (!__atomic_compare_exchange_n(&w->isr_works, &head, work, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief 工作项计入当前刷新纪元（需在临界区或中断中调用，与纪元切换互斥）
+ * @return 计入的纪元
+ */
+static uint8_t epoch_enter(worker_t *w)
+{
+    uint8_t epoch = w->epoch;
+
+    __atomic_fetch_add(&w->inflight[epoch], 1, __ATOMIC_RELAXED);
+    return epoch;
+}
+
+/**
+ * @brief 工作项执行完毕或被丢弃，所属纪元计数减一（需在临界区内调用）
+ * @return true:正在等待的纪元已清零，需唤醒刷新者
+ */
+static bool epoch_exit(worker_t *w, uint8_t epoch)
+{
+    if (__atomic_sub_fetch(&w->inflight[epoch], 1, __ATOMIC_RELAXED) == 0 &&
+        w->flush_waiting && w->flush_epoch == epoch)
+    {
+        w->flush_waiting = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 记录侵入式工作对象所属的纪元（对象已由调用者置为排队状态）
+ */
+static void work_set_epoch(worker_work_t *work, uint8_t epoch)
+{
+    if (epoch)
+    {
+        __atomic_fetch_or(&work->state, WORK_STATE_EPOCH, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_fetch_and(&work->state, (uint8_t)~WORK_STATE_EPOCH, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief 工作项被接受，完成句柄进入等待状态
+ */
+static void future_arm(worker_future_t *future)
+{
+    if (future)
+    {
+        future->waiter = NULL;
+        __atomic_store_n(&future->state, WORKER_FUTURE_PENDING, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief 设置完成句柄的最终状态并唤醒等待者
+ */
+static void future_finish(worker_future_t *future, uint8_t state)
+{
+    TaskHandle_t waiter;
+
+    if (!future)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    waiter = future->waiter;
+    future->waiter = NULL;
+    __atomic_store_n(&future->state, state, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL();
+
+    if (waiter)
+    {
+        xTaskNotifyGiveIndexed(waiter, WORKER_FUTURE_NOTIFY_INDEX);
+    }
+}
+
+/**
+ * @brief 工作项对应的优先级类别下标（0为最低）
+ */
+static uint32_t work_prio_class(const worker_queue_item_t *item)
+{
+    uint8_t prio = item->prio;
+
+    if (prio == WORKER_PRIO_DEFAULT || prio >= WORKER_PRIO_MAX)
+    {
+        prio = (item->flags & WORKER_FLAG_HIGH_PRIO) ? WORKER_PRIO_HIGH : WORKER_PRIO_NORMAL;
+    }
+    return prio - WORKER_PRIO_LOW;
+}
+
+/**
+ * @brief 工作对象放入队列并计数（需在临界区内调用）
+ *
+ * 截止时间任务进入共享的EDF队列，其余任务进入目标线程对应类别队列的尾部。
+ */
+static void enqueue_local(worker_thread_t *t, worker_work_t *work)
+{
+    worker_t *w = t->wq;
+
+    if (work->item.flags & WORKER_FLAG_DEADLINE)
+    {
+        deque_insert_by_deadline(&w->edf, work);
+    }
+    else
+    {
+        deque_push_back(&t->queues[work_prio_class(&work->item)], work);
+        t->queued++;
+    }
+    w->pending++;
+    if (w->pending > w->high_water)
+    {
+        w->high_water = w->pending;
+    }
+}
+
+/**
+ * @brief 查找调用者所在的工作线程（非工作线程返回NULL）
+ */
+static worker_thread_t *current_worker_thread(worker_t *w)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        if (w->threads[i].task_handle == self)
+        {
+            return &w->threads[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 选择工作项的目标线程（需在临界区内调用）
+ *
+ * 工作线程提交的任务放入自己的本地队列，外部提交按轮询分配。
+ */
+static worker_thread_t *select_target_thread(worker_t *w, worker_thread_t *self)
+{
+    if (self)
+    {
+        return self;
+    }
+
+    worker_thread_t *target = &w->threads[w->next_thread];
+    w->next_thread = (w->next_thread + 1) % w->thread_num;
+    return target;
+}
+
+/**
+ * @brief 查找一个空闲线程用于窃取（需在临界区内调用）
+ */
+static worker_thread_t *find_idle_thread(const worker_thread_t *except)
+{
+    worker_t *w = except->wq;
+
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        worker_thread_t *t = &w->threads[i];
+        if (t != except && !t->busy && t->queued == 0)
+        {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 是否有其他未在执行工作项的线程（需在临界区内调用）
+ */
+static bool has_free_thread(const worker_thread_t *except)
+{
+    worker_t *w = except->wq;
+
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        const worker_thread_t *t = &w->threads[i];
+        if (t != except && !t->busy)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 队列满时的处理上下文
 typedef struct
 {
-    TaskHandle_t task_handle;    // 主工作线程句柄
-    QueueHandle_t work_queue;    // 工作队列
-    SemaphoreHandle_t flush_sem; // 刷新信号量
+    uint8_t policy;             // 处理策略（worker_overflow_t）
+    bool coalesced;             // 已与队列中相同回调的工作项合并
+    bool evicted;               // 已挤出一个工作项
+    bool flushed;               // 挤出后等待中的纪元清零，需唤醒刷新者
+    worker_queue_item_t victim; // 被挤出的工作项
+} worker_overflow_ctx_t;
+
+/**
+ * @brief 队列中是否有相同回调的工作项在等待（需在临界区内调用）
+ */
+static bool worker_has_pending_cb(worker_t *w, worker_cb_t cb)
+{
+    for (worker_work_t *node = w->edf.head; node; node = node->next)
+    {
+        if (node->item.cb == cb)
+        {
+            return true;
+        }
+    }
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        for (int c = 0; c < WORKER_PRIO_CLASS_NUM; c++)
+        {
+            for (worker_work_t *node = w->threads[i].queues[c].head; node; node = node->next)
+            {
+                if (node->item.cb == cb)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 摘除排队最久的节点池工作项（需在临界区内调用）
+ *
+ * 从最低类别开始，只在不高于max_class的类别中查找；截止时间任务和侵入式工作对象不会被挤出。
+ *
+ * @return 被摘除的节点（仍带有原工作项），没有可挤出的节点时返回NULL
+ */
+static worker_work_t *worker_evict_oldest(worker_t *w, uint32_t max_class)
+{
+    for (uint32_t c = 0; c <= max_class; c++)
+    {
+        worker_thread_t *owner = NULL;
+        worker_work_t *victim = NULL;
+        worker_work_t *victim_prev = NULL;
+
+        for (uint8_t i = 0; i < w->thread_num; i++)
+        {
+            worker_work_t *prev = NULL;
+            worker_work_t *node = w->threads[i].queues[c].head;
+
+            // 每个队列中第一个节点池节点就是该队列中最早的
+            while (node && !(node->state & WORK_STATE_POOLED))
+            {
+                prev = node;
+                node = node->next;
+            }
+            if (node && (!victim || (int32_t)(node->seq - victim->seq) < 0))
+            {
+                owner = &w->threads[i];
+                victim = node;
+                victim_prev = prev;
+            }
+        }
+
+        if (victim)
+        {
+            deque_remove(&owner->queues[c], victim_prev, victim);
+            owner->queued--;
+            w->pending--;
+            return victim;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 节点池已满时按策略处理（需在临界区内调用）
+ * @return true:已腾出一个空闲节点
+ */
+static bool worker_overflow(worker_t *w, const worker_queue_item_t *item, worker_overflow_ctx_t *ovf)
+{
+    if (ovf->policy == WORKER_OVERFLOW_COALESCE)
+    {
+        // 合并的项不会执行，带future时等待者得不到结果：按拒绝处理
+        if (item->future == NULL && worker_has_pending_cb(w, item->cb))
+        {
+            ovf->coalesced = true;
+            w->coalesced++;
+        }
+        return false;
+    }
+
+    if (ovf->policy == WORKER_OVERFLOW_DROP_OLDEST && !ovf->evicted)
+    {
+        worker_work_t *victim = worker_evict_oldest(w, work_prio_class(item));
+        if (victim)
+        {
+            ovf->evicted = true;
+            ovf->victim = victim->item;
+            ovf->flushed = epoch_exit(w, (victim->state & WORK_STATE_EPOCH) ? 1 : 0);
+            __atomic_fetch_add(&w->dropped, 1, __ATOMIC_RELAXED);
+
+            victim->state = WORK_STATE_POOLED;
+            victim->next = w->free_list;
+            w->free_list = victim;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief 在一个临界区内将多个工作项放入线程池
+ * @param wait_space 一项都放不下时是否登记为等待者（由调用者随后等待space_sem）
+ * @param ovf 节点池满时的处理上下文（NULL为直接拒绝）
+ * @return 放入的工作项数（节点池不足时小于n）
+ */
+static uint32_t worker_enqueue_items(worker_t *w, const worker_queue_item_t *items, uint32_t n,
+                                     bool wait_space, worker_overflow_ctx_t *ovf)
+{
+    worker_thread_t *self = current_worker_thread(w);
+    uint32_t stamp = WORKER_STAMP();
+    uint32_t notify_mask = 0;
+    uint32_t count = 0;
+
+    taskENTER_CRITICAL();
+    while (count < n)
+    {
+        if (!w->free_list && !(ovf && worker_overflow(w, &items[count], ovf)))
+        {
+            break;
+        }
+
+        worker_work_t *node = w->free_list;
+        w->free_list = node->next;
+        node->item = items[count++];
+        node->stamp = stamp;
+        node->seq = w->submit_seq++;
+        node->state = WORK_STATE_POOLED | WORK_STATE_PENDING |
+                      (epoch_enter(w) ? WORK_STATE_EPOCH : 0);
+        future_arm(node->item.future);
+
+        worker_thread_t *target = select_target_thread(w, self);
+        enqueue_local(target, node);
+        notify_mask |= 1u << target->index;
+    }
+    __atomic_fetch_add(&w->accepted, count, __ATOMIC_RELAXED);
+
+    if (count == 0 && wait_space)
+    {
+        w->space_waiters++;
+    }
+
+    // 目标线程忙时唤醒一个空闲线程来窃取
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        worker_thread_t *t = &w->threads[i];
+        if ((notify_mask & (1u << i)) && t->busy)
+        {
+            worker_thread_t *thief = find_idle_thread(t);
+            if (thief)
+            {
+                notify_mask |= 1u << thief->index;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        if (notify_mask & (1u << i))
+        {
+            xTaskNotifyGive(w->threads[i].task_handle);
+        }
+    }
+
+    if (ovf && ovf->flushed)
+    {
+        xSemaphoreGive(w->flush_sem);
+    }
+
+    return count;
+}
+
+/**
+ * @brief 将工作项放入线程池
+ * @param wait_space 队列满时是否登记为等待者（由调用者随后等待space_sem）
+ * @return 0:成功 -1:队列满
+ */
+static int worker_enqueue(worker_t *w, const worker_queue_item_t *item, bool wait_space)
+{
+    return (worker_enqueue_items(w, item, 1, wait_space, NULL) == 1) ? 0 : -1;
+}
+
+/**
+ * @brief 将工作项放入线程池，队列满时最多等待timeout，超时计入dropped
+ * @return 0:成功 -1:超时
+ */
+static int worker_enqueue_wait(worker_t *w, const worker_queue_item_t *item, TickType_t timeout)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    while (worker_enqueue(w, item, timeout > 0) != 0)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        BaseType_t got = pdFALSE;
+
+        if (timeout == 0)
+        {
+            __atomic_fetch_add(&w->dropped, 1, __ATOMIC_RELAXED);
+            return -1; // 未登记为等待者
+        }
+
+        if (elapsed < timeout)
+        {
+            got = xSemaphoreTake(w->space_sem, timeout - elapsed);
+        }
+
+        taskENTER_CRITICAL();
+        w->space_waiters--;
+        taskEXIT_CRITICAL();
+
+        if (got != pdTRUE)
+        {
+            __atomic_fetch_add(&w->dropped, 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 按调度顺序取出一个工作对象（需在临界区内调用）
+ *
+ * 截止时间最早的任务优先，其次从高到低按类别取：先取本地队列，为空时从其他线程窃取同类别任务。
+ */
+static worker_work_t *worker_pop_next(worker_thread_t *self, bool allow_steal)
+{
+    worker_t *w = self->wq;
+
+    worker_work_t *node = deque_pop_front(&w->edf);
+    for (int c = WORKER_PRIO_CLASS_NUM - 1; c >= 0 && !node; c--)
+    {
+        node = deque_pop_front(&self->queues[c]);
+        if (node)
+        {
+            self->queued--;
+            break;
+        }
+
+        for (uint8_t i = 1; allow_steal && i < w->thread_num && !node; i++)
+        {
+            worker_thread_t *victim = &w->threads[(self->index + i) % w->thread_num];
+            node = deque_pop_front(&victim->queues[c]);
+            if (node)
+            {
+                victim->queued--;
+                self->stolen++;
+            }
+        }
+    }
+    return node;
+}
+
+/**
+ * @brief 一次取出最多max个工作项：先取本地队列，为空时从其他线程窃取
+ *
+ * 只有第一项允许窃取；有其他空闲线程时只取一项，剩余任务留给空闲线程窃取，
+ * 避免排在耗时回调后面。
+ *
+ * @return 取到的工作项数（已复制到out）
+ */
+static uint32_t worker_dequeue(worker_thread_t *self, worker_exec_t *out, uint32_t max)
+{
+    worker_t *w = self->wq;
+    bool wake_space = false;
+    uint32_t n = 0;
+
+    taskENTER_CRITICAL();
+
+    // 把中断提交的工作对象转入本地队列（无锁栈为后进先出，先反转恢复提交顺序）
+    worker_work_t *isr_list = __atomic_exchange_n(&w->isr_works, NULL, __ATOMIC_ACQUIRE);
+    worker_work_t *ordered = NULL;
+    while (isr_list)
+    {
+        worker_work_t *next = isr_list->next;
+        isr_list->next = ordered;
+        ordered = isr_list;
+        isr_list = next;
+    }
+    while (ordered)
+    {
+        worker_work_t *next = ordered->next;
+        enqueue_local(self, ordered);
+        __atomic_fetch_sub(&w->isr_work_count, 1, __ATOMIC_RELAXED);
+        ordered = next;
+    }
+
+    // 把中断提交的工作项转入本地队列，按类别放入对应队列
+    while (w->free_list && !isr_ring_empty(&w->isr_ring))
+    {
+        worker_work_t *isr_node = w->free_list;
+        uint8_t epoch;
+        if (!isr_ring_pop(&w->isr_ring, &isr_node->item, &isr_node->stamp, &epoch))
+        {
+            break;
+        }
+        w->free_list = isr_node->next;
+        isr_node->seq = w->submit_seq++;
+        isr_node->state = WORK_STATE_POOLED | WORK_STATE_PENDING |
+                          (epoch ? WORK_STATE_EPOCH : 0);
+        enqueue_local(self, isr_node);
+    }
+
+    while (n < max)
+    {
+        if (n > 0 && has_free_thread(self))
+        {
+            break;
+        }
+
+        worker_work_t *node = worker_pop_next(self, n == 0);
+        if (!node)
+        {
+            break;
+        }
+
+        out[n].item = node->item;
+        out[n].stamp = node->stamp;
+        out[n].epoch = (node->state & WORK_STATE_EPOCH) ? 1 : 0;
+        n++;
+        if (node->state & WORK_STATE_POOLED)
+        {
+            node->next = w->free_list;
+            w->free_list = node;
+            wake_space = w->space_waiters > 0;
+        }
+        else
+        {
+            // 执行前清除排队状态，回调执行期间可以再次提交
+            __atomic_fetch_and(&node->state, (uint8_t)~(WORK_STATE_PENDING | WORK_STATE_EPOCH),
+                               __ATOMIC_RELEASE);
+        }
+        w->pending--;
+        w->active++;
+    }
+    if (n > 0)
+    {
+        self->busy = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (wake_space)
+    {
+        xSemaphoreGive(w->space_sem);
+    }
+
+    return n;
+}
+
+/**
+ * @brief 中断提交后唤醒工作线程：优先唤醒空闲线程，全部忙碌时唤醒0号线程
+ */
+static void worker_wake_from_isr(worker_t *w, BaseType_t *higher_prio_woken)
+{
+    worker_thread_t *target = &w->threads[0];
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        if (!w->threads[i].busy)
+        {
+            target = &w->threads[i];
+            break;
+        }
+    }
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(target->task_handle, &woken);
+    if (higher_prio_woken)
+    {
+        *higher_prio_woken |= woken;
+    }
+}
+
+/**
+ * @brief 定时对象挂入时间轮（需在临界区内调用）
+ */
+static void timer_wheel_insert(worker_t *w, worker_timer_t *timer)
+{
+    worker_timer_t **slot = &w->wheel[timer->expires & WORKER_TIMER_WHEEL_MASK];
+
+    timer->next = *slot;
+    *slot = timer;
+    timer->wq = w;
+    timer->armed = 1;
+    w->timer_count++;
+}
+
+/**
+ * @brief 定时对象从时间轮摘除（需在临界区内调用）
+ */
+static void timer_wheel_remove(worker_timer_t *timer)
+{
+    worker_t *w = timer->wq;
+    worker_timer_t **pp = &w->wheel[timer->expires & WORKER_TIMER_WHEEL_MASK];
+
+    while (*pp && *pp != timer)
+    {
+        pp = &(*pp)->next;
+    }
+    if (*pp)
+    {
+        *pp = timer->next;
+        w->timer_count--;
+    }
+    timer->next = NULL;
+    timer->armed = 0;
+}
+
+/**
+ * @brief 处理到期的定时对象（调用者持有wheel_lock）
+ *
+ * 从上次处理的tick开始逐槽检查到当前tick，落后超过一圈时每槽只检查一次。
+ * 周期对象在同一临界区内重新挂入，取消操作不会看到中间状态。
+ */
+static void timer_wheel_run(worker_t *w)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    if (w->timer_count == 0)
+    {
+        w->wheel_tick = now + 1;
+        return;
+    }
+    if ((int32_t)(now - w->wheel_tick) < 0)
+    {
+        return; // 本tick已处理
+    }
+
+    TickType_t elapsed = now - w->wheel_tick + 1;
+    uint32_t slots = (elapsed > WORKER_TIMER_WHEEL_SIZE) ? WORKER_TIMER_WHEEL_SIZE : elapsed;
+    for (uint32_t i = 0; i < slots; i++)
+    {
+        uint32_t idx = (w->wheel_tick + i) & WORKER_TIMER_WHEEL_MASK;
+
+        for (;;)
+        {
+            worker_timer_t *fired = NULL;
+
+            taskENTER_CRITICAL();
+            for (worker_timer_t *t = w->wheel[idx]; t; t = t->next)
+            {
+                if ((int32_t)(t->expires - now) <= 0)
+                {
+                    fired = t;
+                    break;
+                }
+            }
+            if (fired)
+            {
+                timer_wheel_remove(fired);
+                if (fired->period)
+                {
+                    // 周期对象按固定节拍累加，落后超过一个周期时从当前时间重新对齐
+                    fired->expires += fired->period;
+                    if ((int32_t)(fired->expires - now) <= 0)
+                    {
+                        fired->expires = now + fired->period;
+                    }
+                    timer_wheel_insert(w, fired);
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if (!fired)
+            {
+                break;
+            }
+            workqueue_queue_work(w, &fired->work);
+        }
+    }
+
+    w->wheel_tick = now + 1;
+}
+
+/**
+ * @brief 计算负责时间轮的空闲线程的等待时间（到最近到期时间为止）
+ *
+ * 从下一个tick对应的槽开始查找，在一圈内找到到期对象即可提前结束。
+ */
+static TickType_t timer_wheel_next_timeout(worker_t *w)
+{
+    TickType_t now = xTaskGetTickCount();
+    TickType_t min_delta = portMAX_DELAY;
+
+    for (uint32_t i = 0; i < WORKER_TIMER_WHEEL_SIZE && w->timer_count > 0; i++)
+    {
+        uint32_t idx = (now + 1 + i) & WORKER_TIMER_WHEEL_MASK;
+
+        taskENTER_CRITICAL();
+        for (worker_timer_t *t = w->wheel[idx]; t; t = t->next)
+        {
+            int32_t delta = (int32_t)(t->expires - now);
+            if (delta <= 0)
+            {
+                min_delta = 0;
+            }
+            else if ((TickType_t)delta < min_delta)
+            {
+                min_delta = (TickType_t)delta;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if (min_delta <= i + 1)
+        {
+            break;
+        }
+    }
+
+    return min_delta;
+}
+
+/**
+ * @brief 尝试处理到期的定时对象（工作线程在取工作项和执行每个工作项之前调用）
+ *
+ * 任一线程都可以处理，同一时间只有一个线程处理，其他线程不等待。
+ * 本tick已处理过时只比较一次tick，开销可以忽略。
+ */
+static void timer_wheel_poll(worker_t *w)
+{
+    if ((int32_t)(xTaskGetTickCount() - w->wheel_tick) < 0)
+    {
+        return;
+    }
+    if (__atomic_exchange_n(&w->wheel_lock, 1, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+    timer_wheel_run(w);
+    __atomic_store_n(&w->wheel_lock, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 唤醒负责时间轮的线程重新计算等待时间
+ *
+ * 没有负责的线程时唤醒一个空闲线程接手；全部忙碌时各线程在执行每个工作项前检查到期。
+ */
+static void timer_wheel_kick(worker_t *w, worker_thread_t *self)
+{
+    worker_thread_t *target = w->wheel_keeper;
+
+    for (uint8_t i = 0; i < w->thread_num && !target; i++)
+    {
+        if (&w->threads[i] != self && !w->threads[i].busy)
+        {
+            target = &w->threads[i];
+        }
+    }
+    if (target && target != self)
+    {
+        xTaskNotifyGive(target->task_handle);
+    }
+}
+
+#if WORKER_PROFILE_ENABLE
+static uint32_t profile_cycles_per_us(void)
+{
+    if (g_profile.cycles_per_us == 0)
+    {
+        g_profile.cycles_per_us = get_system_clock_freq() / 1000000;
+        if (g_profile.cycles_per_us == 0)
+        {
+            g_profile.cycles_per_us = 1;
+        }
+    }
+    return g_profile.cycles_per_us;
+}
+
+static uint32_t profile_cycles_to_us(uint32_t cycles)
+{
+    return cycles / profile_cycles_per_us();
+}
+
+/**
+ * @brief 计算直方图桶号：桶0为<1us，桶k为[2^(k-1), 2^k)us
+ */
+static uint32_t profile_hist_bin(uint32_t cycles)
+{
+    uint32_t us = profile_cycles_to_us(cycles);
+    uint32_t bin = (us == 0) ? 0 : 32 - __builtin_clz(us);
+
+    return (bin < WORKER_PROFILE_HIST_BINS) ? bin : WORKER_PROFILE_HIST_BINS - 1;
+}
+
+/**
+ * @brief 在前used个表项中查找名称（不需要临界区），未找到返回-1
+ *
+ * 表项的名称写入后直到清空前不变，可以在临界区外查找。
+ * 名称通常是字符串常量，先只比较指针，都不相同时再比较内容。
+ */
+static int profile_lookup(const char *name, uint32_t from, uint32_t used)
+{
+    for (uint32_t i = from; i < used; i++)
+    {
+        if (g_profile.slots[i].name == name)
+        {
+            return (int)i;
+        }
+    }
+    for (uint32_t i = from; i < used; i++)
+    {
+        const char *slot_name = g_profile.slots[i].name;
+        if (slot_name && strcmp(slot_name, name) == 0)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 查找或追加名称对应的表项（需在临界区内调用），表满时返回最后一项
+ * @param from 前from个表项已在临界区外查找过
+ */
+static worker_profile_slot_t *profile_find_slot(const char *name, uint32_t from)
+{
+    int index = profile_lookup(name, from, g_profile.used);
+    if (index >= 0)
+    {
+        return &g_profile.slots[index];
+    }
+
+    worker_profile_slot_t *slot = &g_profile.slots[WORKER_PROFILE_SLOTS - 1];
+    if (g_profile.used < WORKER_PROFILE_SLOTS - 1)
+    {
+        slot = &g_profile.slots[g_profile.used];
+        slot->name = name;
+        __atomic_store_n(&g_profile.used, g_profile.used + 1, __ATOMIC_RELEASE);
+    }
+    else if (g_profile.used == WORKER_PROFILE_SLOTS - 1)
+    {
+        slot->name = "<other>";
+        __atomic_store_n(&g_profile.used, g_profile.used + 1, __ATOMIC_RELEASE);
+    }
+    if (slot->count == 0)
+    {
+        slot->exec_min = UINT32_MAX;
+        slot->wait_min = UINT32_MAX;
+    }
+    return slot;
+}
+
+/**
+ * @brief 记录一次执行的排队时间和执行时间
+ *
+ * 名称在临界区外查找，临界区内只更新计数和直方图；新名称（或期间表被清空）
+ * 才在临界区内查找其他线程新追加的表项并追加。
+ */
+static void profile_record(const char *name, uint32_t wait_cycles, uint32_t exec_cycles)
+{
+    uint32_t exec_bin = profile_hist_bin(exec_cycles);
+    uint32_t wait_bin = profile_hist_bin(wait_cycles);
+    worker_profile_slot_t *slot;
+
+    if (!name)
+    {
+        name = "<unnamed>";
+    }
+    uint32_t generation = __atomic_load_n(&g_profile.generation, __ATOMIC_ACQUIRE);
+    uint32_t used = __atomic_load_n(&g_profile.used, __ATOMIC_ACQUIRE);
+    int index = profile_lookup(name, 0, used);
+
+    taskENTER_CRITICAL();
+    if (generation != g_profile.generation)
+    {
+        slot = profile_find_slot(name, 0);
+    }
+    else if (index < 0)
+    {
+        slot = profile_find_slot(name, used);
+    }
+    else
+    {
+        slot = &g_profile.slots[index];
+    }
+    slot->count++;
+    slot->exec_sum += exec_cycles;
+    slot->wait_sum += wait_cycles;
+    if (exec_cycles < slot->exec_min)
+    {
+        slot->exec_min = exec_cycles;
+    }
+    if (exec_cycles > slot->exec_max)
+    {
+        slot->exec_max = exec_cycles;
+    }
+    if (wait_cycles < slot->wait_min)
+    {
+        slot->wait_min = wait_cycles;
+    }
+    if (wait_cycles > slot->wait_max)
+    {
+        slot->wait_max = wait_cycles;
+    }
+    if (slot->exec_hist[exec_bin] < UINT16_MAX)
+    {
+        slot->exec_hist[exec_bin]++;
+    }
+    if (slot->wait_hist[wait_bin] < UINT16_MAX)
+    {
+        slot->wait_hist[wait_bin]++;
+    }
+    taskEXIT_CRITICAL();
+}
+#else
+#define profile_record(name, wait_cycles, exec_cycles) ((void)(name), (void)(wait_cycles), (void)(exec_cycles))
+#endif
+
+/**
+ * @brief 忙碌时间（WORKER_BUSY_CLOCK单位）换算为微秒
+ */
+static uint64_t worker_busy_to_us(uint64_t busy_time)
+{
+#if WORKER_PROFILE_ENABLE
+    return busy_time / profile_cycles_per_us();
+#else
+    return busy_time * 1000000U / configTICK_RATE_HZ;
+#endif
+}
+
+/**
+ * @brief 检查截止时间任务是否按时完成
+ */
+static void worker_check_deadline(worker_t *w, const worker_queue_item_t *item)
+{
+    if (!(item->flags & WORKER_FLAG_DEADLINE))
+    {
+        return;
+    }
+
+    int32_t lateness = (int32_t)(xTaskGetTickCount() - item->deadline);
+    if (lateness > 0)
+    {
+        worker_deadline_miss_cb_t cb = g_deadline_miss_cb;
+
+        taskENTER_CRITICAL();
+        w->deadline_missed++;
+        taskEXIT_CRITICAL();
+
+        if (cb)
+        {
+            cb(item, (TickType_t)lateness);
+        }
+    }
+}
+
+/**
+ * @brief 一批工作项执行完毕，所属纪元计数减一，等待中的纪元清零时唤醒刷新者
+ */
+static void worker_complete(worker_thread_t *self, const worker_exec_t *done, uint32_t n)
+{
+    worker_t *w = self->wq;
+    bool flushed = false;
+
+    taskENTER_CRITICAL();
+    w->active -= n;
+    self->busy = false;
+    self->executed += n;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        flushed |= epoch_exit(w, done[i].epoch);
+    }
+    taskEXIT_CRITICAL();
+
+    if (flushed)
+    {
+        xSemaphoreGive(w->flush_sem);
+    }
+}
+
+/**
+ * @brief 暂停：应答控制者后停在等待通知处，直到暂停消息被清除
+ *
+ * 暂停期间的提交通知只会让线程醒来重新检查控制消息，不会取工作项。
+ */
+static void worker_thread_park(worker_thread_t *self)
+{
+    worker_t *w = self->wq;
+
+    xSemaphoreGive(w->ctrl_sem);
+    while ((w->ctrl & (WORKER_CTRL_SUSPEND | WORKER_CTRL_SHUTDOWN)) == WORKER_CTRL_SUSPEND)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief 主工作线程函数
+ *
+ * 完全由事件驱动：没有工作项时无限期等待提交通知（负责时间轮的一个空闲线程最多等到最近的定时到期），
+ * 关闭和暂停也通过控制消息加通知送达，空闲时不会周期性醒来。
+ * 负责时间轮的线程取到工作项后交给另一个空闲线程，慢回调不会推迟定时对象。
+ */
+static void worker_thread_function(void *param)
+{
+    worker_thread_t *self = (worker_thread_t *)param;
+    worker_t *w = self->wq;
+    worker_exec_t batch[WORKER_DRAIN_BATCH];
+
+    for (;;)
+    {
+        uint8_t ctrl = w->ctrl;
+        if (ctrl & WORKER_CTRL_SHUTDOWN)
+        {
+            break;
+        }
+        if (ctrl & WORKER_CTRL_SUSPEND)
+        {
+            worker_thread_park(self);
+            continue;
+        }
+
+        timer_wheel_poll(w);
+
+        // 每次唤醒最多取出一批工作项，执行完整批后再检查关闭和刷新状态
+        uint32_t n = worker_dequeue(self, batch, WORKER_DRAIN_BATCH);
+        if (n > 0)
+        {
+            // 执行期间不再负责时间轮，交给另一个空闲线程
+            if (w->wheel_keeper == self)
+            {
+                w->wheel_keeper = NULL;
+                if (w->timer_count > 0)
+                {
+                    timer_wheel_kick(w, self);
+                }
+            }
+
+            uint32_t busy_start = WORKER_BUSY_CLOCK();
+            for (uint32_t i = 0; i < n; i++)
+            {
+                if (i > 0)
+                {
+                    timer_wheel_poll(w);
+                }
+                uint32_t start = WORKER_STAMP();
+                execute_work_item(&batch[i].item);
+                profile_record(batch[i].item.name, start - batch[i].stamp, WORKER_STAMP() - start);
+                worker_check_deadline(w, &batch[i].item);
+                future_finish(batch[i].item.future, WORKER_FUTURE_DONE);
+            }
+            self->busy_time += (uint32_t)(WORKER_BUSY_CLOCK() - busy_start);
+            worker_complete(self, batch, n);
+        }
+        else
+        {
+            // 没有工作项：等待提交通知，没有其他线程负责时间轮时接手，最多等到最近的定时到期时间
+            // （先登记再计算等待时间，之后挂入的定时对象会通知本线程）
+            bool keeper;
+            taskENTER_CRITICAL();
+            if (w->wheel_keeper == NULL)
+            {
+                w->wheel_keeper = self;
+            }
+            keeper = (w->wheel_keeper == self);
+            taskEXIT_CRITICAL();
+
+            TickType_t wait = keeper ? timer_wheel_next_timeout(w) : portMAX_DELAY;
+            ulTaskNotifyTake(pdTRUE, wait);
+            self->wakeups++;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    w->running_threads--;
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(w->ctrl_sem);
+
+    // 由关闭者删除本线程：删除其他任务时立即回收，静态控制块和栈随后可安全复用
+    for (;;)
+    {
+        vTaskSuspend(NULL);
+    }
+}
+
+/**
+ * @brief 清除仍在队列中的侵入式工作对象的排队状态，销毁后可重新提交；
+ *        未执行工作项的完成句柄置为已取消
+ */
+static void worker_detach_works(worker_t *w)
+{
+    worker_work_t *work;
+    worker_queue_item_t item;
+    uint32_t stamp;
+    uint8_t epoch;
+
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        for (int c = 0; c < WORKER_PRIO_CLASS_NUM; c++)
+        {
+            while ((work = deque_pop_front(&w->threads[i].queues[c])) != NULL)
+            {
+                work->state &= WORK_STATE_POOLED;
+                future_finish(work->item.future, WORKER_FUTURE_CANCELLED);
+            }
+        }
+    }
+    while ((work = deque_pop_front(&w->edf)) != NULL)
+    {
+        work->state &= WORK_STATE_POOLED;
+        future_finish(work->item.future, WORKER_FUTURE_CANCELLED);
+    }
+
+    work = __atomic_exchange_n(&w->isr_works, NULL, __ATOMIC_ACQUIRE);
+    while (work)
+    {
+        worker_work_t *next = work->next;
+        work->state = 0;
+        future_finish(work->item.future, WORKER_FUTURE_CANCELLED);
+        work = next;
+    }
+
+    while (isr_ring_pop(&w->isr_ring, &item, &stamp, &epoch))
+    {
+        future_finish(item.future, WORKER_FUTURE_CANCELLED);
+    }
+
+    for (uint32_t i = 0; i < WORKER_TIMER_WHEEL_SIZE; i++)
+    {
+        while (w->wheel[i])
+        {
+            timer_wheel_remove(w->wheel[i]);
+        }
+    }
+}
+
+static void worker_release_resources(worker_t *w)
+{
+    if (w->nodes)
+    {
+#if !WORKER_STATIC_ALLOC
+        vPortFree(w->nodes);
+#endif
+        w->nodes = NULL;
+    }
+    if (w->flush_sem)
+    {
+        vSemaphoreDelete(w->flush_sem);
+        w->flush_sem = NULL;
+    }
+    if (w->space_sem)
+    {
+        vSemaphoreDelete(w->space_sem);
+        w->space_sem = NULL;
+    }
+    if (w->flush_lock)
+    {
+        vSemaphoreDelete(w->flush_lock);
+        w->flush_lock = NULL;
+    }
+    if (w->ctrl_sem)
+    {
+        vSemaphoreDelete(w->ctrl_sem);
+        w->ctrl_sem = NULL;
+    }
+}
+
+/**
+ * @brief 发送控制消息：修改控制位后通知所有工作线程
+ */
+static void worker_post_ctrl(worker_t *w, uint8_t set, uint8_t clear)
+{
+    taskENTER_CRITICAL();
+    w->ctrl = (uint8_t)((w->ctrl & ~clear) | set);
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        if (w->threads[i].task_handle)
+        {
+            xTaskNotifyGive(w->threads[i].task_handle);
+        }
+    }
+}
+
+static void worker_wait_threads_exit(worker_t *w)
+{
+    worker_post_ctrl(w, WORKER_CTRL_SHUTDOWN, 0);
+
+    // 每个线程退出前释放一次应答信号量
+    while (w->running_threads > 0)
+    {
+        xSemaphoreTake(w->ctrl_sem, portMAX_DELAY);
+    }
+
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        if (w->threads[i].task_handle)
+        {
+            vTaskDelete(w->threads[i].task_handle);
+            w->threads[i].task_handle = NULL;
+        }
+    }
+}
+
+// =============================================================================
+// 公共接口实现
+// =============================================================================
+
+/**
+ * @brief 生成工作线程名称：单线程使用工作队列名称，多线程在名称后加序号
+ */
+static void worker_thread_name(const worker_t *w, int index, char *name, size_t size)
+{
+    if (w == &g_default_worker)
+    {
+        // 默认工作队列保持原有线程名
+        if (w->thread_num == 1)
+        {
+            snprintf(name, size, "%s", WORKER_TASK_NAME);
+        }
+        else
+        {
+            snprintf(name, size, "Worker%d", index);
+        }
+    }
+    else if (w->thread_num == 1)
+    {
+        snprintf(name, size, "%s", w->name);
+    }
+    else
+    {
+        snprintf(name, size, "%s%d", w->name, index);
+    }
+}
+
+/**
+ * @brief 初始化工作队列控制结构，创建节点池、信号量和工作线程
+ * @return 0:成功 -1:参数错误 -2:内存不足 -3:创建信号量失败 -4:创建线程失败
+ */
+static int worker_setup(worker_t *w, const worker_config_t *config)
+{
+    if (config->thread_num < 1 || config->thread_num > WORKER_POOL_MAX || config->item_num < 1 ||
+        config->overflow > WORKER_OVERFLOW_COALESCE)
+    {
+        return -1;
+    }
+
+    bool is_static = w->is_static;
+    memset(w, 0, sizeof(*w));
+    w->is_static = is_static;
+    w->name = config->name;
+    w->state = WORKER_STATE_STOPPED;
+    w->overflow = (config->overflow == WORKER_OVERFLOW_DEFAULT) ? WORKER_OVERFLOW_REJECT : config->overflow;
+    w->block_timeout_ms = config->block_timeout_ms;
+    w->drop_cb = config->drop_cb;
+
+    // 创建节点池
+#if WORKER_STATIC_ALLOC
+    if (!config->nodes || !config->stacks)
+    {
+        return -1;
+    }
+    w->nodes = config->nodes;
+#else
+    w->nodes = pvPortMalloc(sizeof(worker_work_t) * config->item_num);
+    if (!w->nodes)
+    {
+        return -2;
+    }
+#endif
+    for (uint32_t i = 0; i < config->item_num; i++)
+    {
+        w->nodes[i].next = (i + 1 < config->item_num) ? &w->nodes[i + 1] : NULL;
+        w->nodes[i].state = WORK_STATE_POOLED;
+    }
+    w->free_list = &w->nodes[0];
+    w->item_num = config->item_num;
+    isr_ring_reset(&w->isr_ring);
+    w->wheel_tick = xTaskGetTickCount();
+    w->start_tick = w->wheel_tick;
+
+#if WORKER_PROFILE_ENABLE
+    // 剖析依赖DWT周期计数器，未启用时才初始化（避免清零其他测量正在使用的计数）
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        dwt_init();
+    }
+#endif
+
+    // 创建刷新信号量、刷新锁和空闲节点信号量
+#if WORKER_STATIC_ALLOC
+    w->flush_sem = xSemaphoreCreateBinaryStatic(&w->flush_sem_buf);
+    w->flush_lock = xSemaphoreCreateMutexStatic(&w->flush_lock_buf);
+    w->space_sem = xSemaphoreCreateBinaryStatic(&w->space_sem_buf);
+    w->ctrl_sem = xSemaphoreCreateCountingStatic(WORKER_POOL_MAX, 0, &w->ctrl_sem_buf);
+#else
+    w->flush_sem = xSemaphoreCreateBinary();
+    w->flush_lock = xSemaphoreCreateMutex();
+    w->space_sem = xSemaphoreCreateBinary();
+    w->ctrl_sem = xSemaphoreCreateCounting(WORKER_POOL_MAX, 0);
+#endif
+    if (!w->flush_sem || !w->flush_lock || !w->space_sem || !w->ctrl_sem)
+    {
+        worker_release_resources(w);
+        return -3;
+    }
+
+    // 创建工作线程
+    w->thread_num = config->thread_num;
+    for (int i = 0; i < config->thread_num; i++)
+    {
+        char name[configMAX_TASK_NAME_LEN];
+        worker_thread_t *t = &w->threads[i];
+
+        worker_thread_name(w, i, name, sizeof(name));
+        t->index = i;
+        t->wq = w;
+        taskENTER_CRITICAL();
+        w->running_threads++;
+        taskEXIT_CRITICAL();
+
+#if WORKER_STATIC_ALLOC
+        uint32_t depth = config->stack_size / sizeof(StackType_t);
+        t->task_handle = xTaskCreateStatic(
+            worker_thread_function,
+            name,
+            depth,
+            t,
+            config->priority,
+            &config->stacks[i * depth],
+            &t->tcb);
+        BaseType_t result = t->task_handle ? pdPASS : pdFAIL;
+#else
+        BaseType_t result = xTaskCreate(
+            worker_thread_function,
+            name,
+            config->stack_size / sizeof(StackType_t),
+            t,
+            config->priority,
+            &t->task_handle);
+#endif
+
+        if (result != pdPASS)
+        {
+            taskENTER_CRITICAL();
+            w->running_threads--;
+            taskEXIT_CRITICAL();
+            t->task_handle = NULL;
+
+            // 停止已创建的线程
+            worker_wait_threads_exit(w);
+            worker_release_resources(w);
+            return -4;
+        }
+    }
+
+    // 初始化状态
+    w->state = WORKER_STATE_RUNNING;
+
+    // 设置魔数表示初始化完成
+    w->magic = WORKER_MAGIC;
+
+    // 挂入工作队列链表
+    taskENTER_CRITICAL();
+    w->next = g_worker_list;
+    g_worker_list = w;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+
+/**
+ * @brief 分配工作队列控制块：静态分配模式下取空闲槽位，否则从堆分配
+ */
+static worker_t *worker_block_alloc(void)
+{
+#if WORKER_STATIC_ALLOC
+    worker_t *w = NULL;
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < WORKER_STATIC_QUEUE_NUM; i++)
+    {
+        if (!g_worker_block_used[i])
+        {
+            g_worker_block_used[i] = true;
+            w = &g_worker_blocks[i];
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return w;
+#else
+    return pvPortMalloc(sizeof(worker_t));
+#endif
+}
+
+static void worker_block_free(worker_t *w)
+{
+#if WORKER_STATIC_ALLOC
+    taskENTER_CRITICAL();
+    g_worker_block_used[w - g_worker_blocks] = false;
+    taskEXIT_CRITICAL();
+#else
+    vPortFree(w);
+#endif
+}
+
+/**
+ * @brief 从工作队列链表摘除
+ */
+static void worker_unlink(worker_t *w)
+{
+    taskENTER_CRITICAL();
+    for (worker_t **pp = &g_worker_list; *pp; pp = &(*pp)->next)
+    {
+        if (*pp == w)
+        {
+            *pp = w->next;
+            break;
+        }
+    }
+    w->next = NULL;
+    taskEXIT_CRITICAL();
+}
+
+worker_t *workqueue_create(const worker_config_t *config)
+{
+    if (!config || !config->name || workqueue_find(config->name))
+    {
+        return NULL; // 参数错误或名称重复
+    }
+
+    worker_t *w = worker_block_alloc();
+    if (!w)
+    {
+        return NULL;
+    }
+
+    w->is_static = false;
+    if (worker_setup(w, config) != 0)
+    {
+        worker_block_free(w);
+        return NULL;
+    }
+
+    return w;
+}
+
+int workqueue_delete(worker_t *w)
+{
+    if (!w || w->magic != WORKER_MAGIC)
+    {
+        return -1;
+    }
+
+    // 工作线程不能等待自己退出
+    if (current_worker_thread(w))
+    {
+        return -1;
+    }
+
+    // 请求关闭并等待所有线程结束（暂停中的线程同样响应关闭消息）
+    worker_wait_threads_exit(w);
+    worker_unlink(w);
+
+    // 删除节点池和信号量
+    worker_detach_works(w);
+    worker_release_resources(w);
+
+    // 清除魔数和状态
+    w->magic = 0;
+    w->state = WORKER_STATE_STOPPED;
+
+    if (!w->is_static)
+    {
+        worker_block_free(w);
+    }
+
+    return 0;
+}
+
+worker_t *workqueue_find(const char *name)
+{
+    worker_t *found = NULL;
+
+    if (!name)
+    {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL();
+    for (worker_t *w = g_worker_list; w; w = w->next)
+    {
+        if (strcmp(w->name, name) == 0)
+        {
+            found = w;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return found;
+}
+
+worker_t *workqueue_get_default(void)
+{
+    return (g_default_worker.magic == WORKER_MAGIC) ? &g_default_worker : NULL;
+}
+
+const char *workqueue_get_name(const worker_t *w)
+{
+    return w ? w->name : NULL;
+}
+
+int worker_pool_init(int thread_num, int item_num, int stack_size, int prior)
+{
+    if (g_default_worker.magic == WORKER_MAGIC)
+    {
+        return -1; // 已初始化
+    }
+
+    if (thread_num < 1 || item_num < 1)
+    {
+        return -1;
+    }
+
+    worker_config_t config = {
+        .name = WORKER_DEFAULT_NAME,
+        .thread_num = thread_num,
+        .item_num = item_num,
+        .stack_size = stack_size,
+        .priority = prior};
+
+#if WORKER_STATIC_ALLOC
+    // 使用静态存储，栈按静态容量分配
+    if (thread_num > WORKER_STATIC_THREAD_NUM || item_num > WORKER_STATIC_ITEM_NUM ||
+        stack_size > WORKER_STATIC_STACK_SIZE)
+    {
+        return -1;
+    }
+    config.stack_size = WORKER_STATIC_STACK_SIZE;
+    config.nodes = g_default_nodes;
+    config.stacks = g_default_stacks;
+#endif
+
+    g_default_worker.is_static = true;
+    return worker_setup(&g_default_worker, &config);
+}
+
+int worker_thread_init(int item_num, int stack_size, int prior)
+{
+    return worker_pool_init(1, item_num, stack_size, prior);
+}
+
+int worker_thread_init_help(void *arg)
+{
+    return worker_thread_init(16, 2048, 4);
+}
+#include "periph_init.h"
+PERIPH_INIT_REGISTER("worker_thread_init", 200, worker_thread_init_help, NULL);
+int worker_thread_destroy(void)
+{
+    return workqueue_delete(&g_default_worker);
+}
+
+int workqueue_send(worker_t *w, worker_queue_item_t *item)
+{
+    if (!w || w->magic != WORKER_MAGIC || !item)
+    {
+        return -1;
+    }
+
+    worker_overflow_ctx_t ovf = {
+        .policy = (item->overflow != WORKER_OVERFLOW_DEFAULT) ? item->overflow : w->overflow};
+
+    if (ovf.policy == WORKER_OVERFLOW_BLOCK)
+    {
+        return worker_enqueue_wait(w, item, pdMS_TO_TICKS(w->block_timeout_ms));
+    }
+
+    int ret = 0;
+    if (worker_enqueue_items(w, item, 1, false, &ovf) != 1)
+    {
+        if (ovf.coalesced)
+        {
+            ret = 1;
+        }
+        else
+        {
+            __atomic_fetch_add(&w->dropped, 1, __ATOMIC_RELAXED);
+            ret = -1;
+        }
+    }
+
+    // 被挤出的工作项不会执行，通知等待者并交给所有者释放资源
+    if (ovf.evicted)
+    {
+        future_finish(ovf.victim.future, WORKER_FUTURE_CANCELLED);
+        if (w->drop_cb)
+        {
+            w->drop_cb(&ovf.victim);
+        }
+    }
+
+    return ret;
+}
+
+int workqueue_set_overflow_policy(worker_t *w, worker_overflow_t policy, uint32_t block_timeout_ms)
+{
+    if (!w || w->magic != WORKER_MAGIC || policy > WORKER_OVERFLOW_COALESCE)
+    {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    w->overflow = (policy == WORKER_OVERFLOW_DEFAULT) ? WORKER_OVERFLOW_REJECT : policy;
+    w->block_timeout_ms = block_timeout_ms;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+
+int worker_set_overflow_policy(worker_overflow_t policy, uint32_t block_timeout_ms)
+{
+    return workqueue_set_overflow_policy(&g_default_worker, policy, block_timeout_ms);
+}
+
+int workqueue_set_drop_callback(worker_t *w, worker_drop_cb_t cb)
+{
+    if (!w || w->magic != WORKER_MAGIC)
+    {
+        return -1;
+    }
+
+    w->drop_cb = cb;
+    return 0;
+}
+
+int worker_set_drop_callback(worker_drop_cb_t cb)
+{
+    return workqueue_set_drop_callback(&g_default_worker, cb);
+}
+
+int worker_send(worker_queue_item_t *item)
+{
+    return workqueue_send(&g_default_worker, item);
+}
+
+int workqueue_send_from_isr(worker_t *w, const worker_queue_item_t *item, BaseType_t *higher_prio_woken)
+{
+    if (!w || w->magic != WORKER_MAGIC || !item)
+    {
+        return -2;
+    }
+
+    // 先计入纪元再写入，避免工作线程取出执行后计数先减
+    uint8_t epoch = epoch_enter(w);
+    future_arm(item->future);
+    if (!isr_ring_push(&w->isr_ring, item, epoch))
+    {
+        __atomic_fetch_sub(&w->inflight[epoch], 1, __ATOMIC_RELAXED);
+        if (item->future)
+        {
+            __atomic_store_n(&item->future->state, WORKER_FUTURE_IDLE, __ATOMIC_RELEASE);
+        }
+        __atomic_fetch_add(&w->isr_dropped, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&w->dropped, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    __atomic_fetch_add(&w->accepted, 1, __ATOMIC_RELAXED);
+
+    worker_wake_from_isr(w, higher_prio_woken);
+    return 0;
+}
+
+int worker_send_from_isr(const worker_queue_item_t *item, BaseType_t *higher_prio_woken)
+{
+    return workqueue_send_from_isr(&g_default_worker, item, higher_prio_woken);
+}
+
+void worker_work_init(worker_work_t *work, worker_cb_t cb, void *arg, const char *name)
+{
+    if (!work)
+    {
+        return;
+    }
+
+    work->next = NULL;
+    work->item.cb = cb;
+    work->item.arg = arg;
+    work->item.flags = WORKER_FLAG_NONE;
+    work->item.name = name;
+    work->item.deadline = 0;
+    work->item.prio = WORKER_PRIO_DEFAULT;
+    work->item.future = NULL;
+    work->state = 0;
+}
+
+int workqueue_queue_work(worker_t *w, worker_work_t *work)
+{
+    if (!w || w->magic != WORKER_MAGIC || !work)
+    {
+        return -1;
+    }
+
+    worker_thread_t *self = current_worker_thread(w);
+    worker_thread_t *target;
+    worker_thread_t *thief = NULL;
+
+    taskENTER_CRITICAL();
+    if (__atomic_fetch_or(&work->state, WORK_STATE_PENDING, __ATOMIC_ACQUIRE) & WORK_STATE_PENDING)
+    {
+        taskEXIT_CRITICAL();
+        return 1; // 已在队列中
+    }
+
+    work->stamp = WORKER_STAMP();
+    work_set_epoch(work, epoch_enter(w));
+    future_arm(work->item.future);
+    __atomic_fetch_add(&w->accepted, 1, __ATOMIC_RELAXED);
+    target = select_target_thread(w, self);
+    enqueue_local(target, work);
+    if (target->busy)
+    {
+        thief = find_idle_thread(target);
+    }
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyGive(target->task_handle);
+    if (thief)
+    {
+        xTaskNotifyGive(thief->task_handle);
+    }
+
+    return 0;
+}
+
+int worker_queue_work(worker_work_t *work)
+{
+    return workqueue_queue_work(&g_default_worker, work);
+}
+
+int workqueue_queue_work_from_isr(worker_t *w, worker_work_t *work, BaseType_t *higher_prio_woken)
+{
+    if (!w || w->magic != WORKER_MAGIC || !work)
+    {
+        return -1;
+    }
 
-    // 状态标志
-    uint16_t magic;                   // 魔数，用于检查初始化状态
-    volatile worker_state_t state;    // Worker状态
-    volatile bool shutdown_requested; // 关闭请求标志
-    volatile bool flush_requested;    // 刷新请求标志
-} worker_control_t;
-
-// 全局worker控制结构
-static worker_control_t g_worker = {
-    .magic = WORKER_MAGIC,
-    .state = WORKER_STATE_STOPPED,
-    .shutdown_requested = false,
-    .flush_requested = false};
+    if (__atomic_fetch_or(&work->state, WORK_STATE_PENDING, __ATOMIC_ACQUIRE) & WORK_STATE_PENDING)
+    {
+        return 1; // 已在队列中
+    }
 
-// =============================================================================
-// 内部辅助函数
-// =============================================================================
+    work->stamp = WORKER_STAMP();
+    work_set_epoch(work, epoch_enter(w));
+    future_arm(work->item.future);
+    __atomic_fetch_add(&w->accepted, 1, __ATOMIC_RELAXED);
+    isr_work_push(w, work);
+    worker_wake_from_isr(w, higher_prio_woken);
+    return 0;
+}
 
-/**
- * @brief 执行工作项
- */
-static void execute_work_item(const worker_queue_item_t *item)
+int worker_queue_work_from_isr(worker_work_t *work, BaseType_t *higher_prio_woken)
 {
-    if (!item || !item->cb)
+    return workqueue_queue_work_from_isr(&g_default_worker, work, higher_prio_woken);
+}
+
+bool worker_work_is_pending(const worker_work_t *work)
+{
+    return work && (work->state & WORK_STATE_PENDING);
+}
+
+void worker_timer_init(worker_timer_t *timer, worker_cb_t cb, void *arg, const char *name)
+{
+    if (!timer)
     {
         return;
     }
 
-    // 执行工作回调
-    item->cb(item->arg);
+    worker_work_init(&timer->work, cb, arg, name);
+    timer->next = NULL;
+    timer->wq = NULL;
+    timer->expires = 0;
+    timer->period = 0;
+    timer->armed = 0;
 }
 
 /**
- * @brief 高优先级任务插入队列头部
+ * @brief 挂入（或重新挂入）工作队列w的时间轮
  */
-static BaseType_t send_to_queue_front(QueueHandle_t queue, const worker_queue_item_t *item, TickType_t timeout)
+static int worker_timer_arm(worker_t *w, worker_timer_t *timer, TickType_t delay, TickType_t period)
 {
-    return xQueueSendToFront(queue, item, timeout);
-}
+    if (!w || w->magic != WORKER_MAGIC || !timer)
+    {
+        return -1;
+    }
 
-/**
- * @brief 主工作线程函数
- */
-static void worker_thread_function(void *param)
-{
-    (void)param;
+    taskENTER_CRITICAL();
+    if (timer->armed)
+    {
+        timer_wheel_remove(timer);
+    }
+    timer->period = period;
+    timer->expires = xTaskGetTickCount() + delay;
+    timer_wheel_insert(w, timer);
+    taskEXIT_CRITICAL();
 
-    worker_queue_item_t work_item;
-    BaseType_t result;
+    timer_wheel_kick(w, NULL);
 
-    g_worker.state = WORKER_STATE_RUNNING;
+    return 0;
+}
 
-    while (!g_worker.shutdown_requested)
-    {
-        // 从队列接收工作项，50ms超时
-        result = xQueueReceive(g_worker.work_queue, &work_item, pdMS_TO_TICKS(50));
+int workqueue_send_delayed(worker_t *w, worker_timer_t *timer, uint32_t delay_ms)
+{
+    TickType_t delay = pdMS_TO_TICKS(delay_ms);
 
-        if (result == pdTRUE)
+    if (delay == 0)
+    {
+        if (!w || w->magic != WORKER_MAGIC || !timer)
         {
-            // 执行工作项
-            execute_work_item(&work_item);
-
-            // 检查是否需要刷新信号
-            if (g_worker.flush_requested)
-            {
-                uint32_t queue_length = uxQueueMessagesWaiting(g_worker.work_queue);
-                if (queue_length == 0)
-                {
-                    g_worker.flush_requested = false;
-                    xSemaphoreGive(g_worker.flush_sem);
-                }
-            }
+            return -1;
         }
+        worker_timer_cancel(timer);
+        return workqueue_queue_work(w, &timer->work) < 0 ? -1 : 0;
     }
 
-    g_worker.state = WORKER_STATE_STOPPED;
-    vTaskDelete(NULL);
+    return worker_timer_arm(w, timer, delay, 0);
 }
 
-// =============================================================================
-// 公共接口实现
-// =============================================================================
+int worker_send_delayed(worker_timer_t *timer, uint32_t delay_ms)
+{
+    return workqueue_send_delayed(&g_default_worker, timer, delay_ms);
+}
 
-int worker_thread_init(int item_num, int stack_size, int prior)
+int workqueue_send_periodic(worker_t *w, worker_timer_t *timer, uint32_t period_ms)
 {
-    // 创建工作队列
-    g_worker.work_queue = xQueueCreate(item_num, sizeof(worker_queue_item_t));
-    if (!g_worker.work_queue)
+    TickType_t period = pdMS_TO_TICKS(period_ms);
+
+    if (period_ms == 0)
     {
-        return -2;
+        return -1;
     }
 
-    // 创建刷新信号量
-    g_worker.flush_sem = xSemaphoreCreateBinary();
-    if (!g_worker.flush_sem)
+    // 周期小于一个tick时按一个tick处理
+    if (period == 0)
     {
-        vQueueDelete(g_worker.work_queue);
-        return -3;
+        period = 1;
     }
 
-    // 创建工作线程
-    BaseType_t result = xTaskCreate(
-        worker_thread_function,
-        WORKER_TASK_NAME,
-        stack_size / sizeof(StackType_t),
-        NULL,
-        prior,
-        &g_worker.task_handle);
+    return worker_timer_arm(w, timer, period, period);
+}
+
+int worker_send_periodic(worker_timer_t *timer, uint32_t period_ms)
+{
+    return workqueue_send_periodic(&g_default_worker, timer, period_ms);
+}
+
+int worker_timer_cancel(worker_timer_t *timer)
+{
+    if (!timer)
+    {
+        return -1;
+    }
 
-    if (result != pdPASS)
+    int ret = 1;
+    taskENTER_CRITICAL();
+    if (timer->armed)
     {
-        vQueueDelete(g_worker.work_queue);
-        vSemaphoreDelete(g_worker.flush_sem);
-        return -4;
+        timer_wheel_remove(timer);
+        ret = 0;
     }
+    taskEXIT_CRITICAL();
 
-    // 初始化状态
-    g_worker.state = WORKER_STATE_RUNNING;
-    g_worker.shutdown_requested = false;
-    g_worker.flush_requested = false;
+    return ret;
+}
 
-    // 设置魔数表示初始化完成
-    g_worker.magic = WORKER_MAGIC;
+int workqueue_send_batch(worker_t *w, const worker_queue_item_t *items, uint32_t n)
+{
+    if (!w || w->magic != WORKER_MAGIC || !items)
+    {
+        return -1;
+    }
 
-    return 0;
+    uint32_t count = worker_enqueue_items(w, items, n, false, NULL);
+    if (count < n)
+    {
+        __atomic_fetch_add(&w->dropped, n - count, __ATOMIC_RELAXED);
+    }
+
+    return (int)count;
 }
 
-int worker_thread_init_help(void *arg)
+int worker_send_batch(const worker_queue_item_t *items, uint32_t n)
 {
-    return worker_thread_init(16, 256 * 4, 3);
+    return workqueue_send_batch(&g_default_worker, items, n);
 }
-#include "periph_init.h"
-PERIPH_INIT_REGISTER("worker_thread_init", 200, worker_thread_init_help, NULL);
-int worker_thread_destroy(void)
+
+int workqueue_send_timeout(worker_t *w, worker_queue_item_t *item, uint32_t timeout_ms)
 {
-    if (g_worker.magic != WORKER_MAGIC)
+    if (!w || w->magic != WORKER_MAGIC || !item)
     {
-        return -1;
+        return -2;
     }
 
-    // 请求关闭
-    g_worker.shutdown_requested = true;
+    return worker_enqueue_wait(w, item, pdMS_TO_TICKS(timeout_ms));
+}
+
+int worker_send_timeout(worker_queue_item_t *item, uint32_t timeout_ms)
+{
+    return workqueue_send_timeout(&g_default_worker, item, timeout_ms);
+}
+
+/**
+ * @brief 等待指定纪元清零
+ * @param switch_epoch 是否先切换纪元（之后提交的工作项计入另一纪元）
+ * @return true:已清零 false:超时
+ */
+static bool worker_wait_epoch(worker_t *w, bool switch_epoch, TickType_t start, TickType_t timeout)
+{
+    // 清除上一次超时遗留的信号（须在登记等待之前）
+    xSemaphoreTake(w->flush_sem, 0);
 
-    // 等待线程结束
-    while (eTaskGetState(g_worker.task_handle) != eDeleted)
+    taskENTER_CRITICAL();
+    uint8_t target = w->epoch;
+    if (switch_epoch)
+    {
+        w->epoch ^= 1;
+    }
+    else
+    {
+        target ^= 1;
+    }
+    bool idle = (w->inflight[target] == 0);
+    if (!idle)
     {
-        vTaskDelay(pdMS_TO_TICKS(10));
+        w->flush_epoch = target;
+        w->flush_waiting = true;
     }
+    taskEXIT_CRITICAL();
 
-    // 删除队列和信号量
-    vQueueDelete(g_worker.work_queue);
-    vSemaphoreDelete(g_worker.flush_sem);
+    if (idle)
+    {
+        return true;
+    }
 
-    // 清除魔数和状态
-    g_worker.magic = 0;
-    g_worker.state = WORKER_STATE_STOPPED;
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed < timeout && xSemaphoreTake(w->flush_sem, timeout - elapsed) == pdTRUE)
+    {
+        return true;
+    }
 
-    return 0;
+    taskENTER_CRITICAL();
+    w->flush_waiting = false;
+    taskEXIT_CRITICAL();
+    return false;
 }
 
-int worker_send(worker_queue_item_t *item)
+int workqueue_flush(worker_t *w, uint32_t timeout_ms)
 {
-    if (g_worker.magic != WORKER_MAGIC || !item)
+    if (!w || w->magic != WORKER_MAGIC)
     {
         return -1;
     }
 
-    BaseType_t result;
-
-    // 根据优先级标志决定插入位置
-    if (item->flags & WORKER_FLAG_HIGH_PRIO)
+    // 正在执行的工作项也属于旧纪元，在工作线程中等待会等到自己
+    if (current_worker_thread(w))
     {
-        // 高优先级任务插入队列头部
-        result = send_to_queue_front(g_worker.work_queue, item, 0);
+        return -1;
     }
-    else
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+
+    // 多个刷新者依次进行，每次只需等待一个纪元
+    if (xSemaphoreTake(w->flush_lock, timeout) != pdTRUE)
     {
-        // 普通任务插入队列尾部
-        result = xQueueSend(g_worker.work_queue, item, 0);
+        return -1;
     }
 
-    return (result == pdTRUE) ? 0 : -1;
+    // 上次刷新超时时另一纪元可能还有更早提交的工作项，先等它清零，
+    // 再切换纪元并等待调用前提交的工作项完成
+    bool done = worker_wait_epoch(w, false, start, timeout) &&
+                worker_wait_epoch(w, true, start, timeout);
+
+    xSemaphoreGive(w->flush_lock);
+
+    return done ? 0 : -1;
 }
 
-int worker_send_timeout(worker_queue_item_t *item, uint32_t timeout_ms)
+int worker_flush(uint32_t timeout_ms)
+{
+    return workqueue_flush(&g_default_worker, timeout_ms);
+}
+
+void worker_future_init(worker_future_t *future)
+{
+    if (future)
+    {
+        future->state = WORKER_FUTURE_IDLE;
+        future->waiter = NULL;
+    }
+}
+
+int worker_future_wait(worker_future_t *future, uint32_t timeout_ms)
 {
-    if (g_worker.magic != WORKER_MAGIC || !item)
+    if (!future)
     {
         return -2;
     }
 
-    BaseType_t result;
-    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    uint8_t state;
+
+    for (;;)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+
+        taskENTER_CRITICAL();
+        state = future->state;
+        if (state == WORKER_FUTURE_PENDING)
+        {
+            future->waiter = (elapsed < timeout) ? self : NULL;
+        }
+        taskEXIT_CRITICAL();
+
+        if (state != WORKER_FUTURE_PENDING || elapsed >= timeout)
+        {
+            break;
+        }
+
+        // 之前超时的等待留下的通知只会多检查一次状态
+        ulTaskNotifyTakeIndexed(WORKER_FUTURE_NOTIFY_INDEX, pdTRUE, timeout - elapsed);
+    }
 
-    // 根据优先级标志决定插入位置
-    if (item->flags & WORKER_FLAG_HIGH_PRIO)
+    switch (state)
     {
-        // 高优先级任务插入队列头部
-        result = send_to_queue_front(g_worker.work_queue, item, timeout_ticks);
+    case WORKER_FUTURE_DONE:
+        return 0;
+    case WORKER_FUTURE_PENDING:
+        return -1;
+    case WORKER_FUTURE_CANCELLED:
+        return -3;
+    default:
+        return -2;
     }
-    else
+}
+
+worker_future_state_t worker_future_poll(const worker_future_t *future)
+{
+    if (!future)
     {
-        // 普通任务插入队列尾部
-        result = xQueueSend(g_worker.work_queue, item, timeout_ticks);
+        return WORKER_FUTURE_IDLE;
     }
 
-    if (result == errQUEUE_FULL)
+    return (worker_future_state_t)__atomic_load_n(&future->state, __ATOMIC_ACQUIRE);
+}
+
+#if WORKER_PROFILE_ENABLE
+/**
+ * @brief 复制一个表项并换算为微秒
+ * @return true:成功 false:下标超出已使用的表项
+ */
+static bool worker_profile_copy(uint32_t index, worker_profile_entry_t *out)
+{
+    worker_profile_slot_t slot;
+
+    taskENTER_CRITICAL();
+    bool valid = index < g_profile.used;
+    if (valid)
     {
-        return -1; // 超时
+        slot = g_profile.slots[index];
     }
-    else if (result != pdTRUE)
+    taskEXIT_CRITICAL();
+
+    if (!valid)
     {
-        return -2; // 其他错误
+        return false;
     }
 
-    return 0;
+    out->name = slot.name;
+    out->count = slot.count;
+    out->exec_min = slot.count ? profile_cycles_to_us(slot.exec_min) : 0;
+    out->exec_max = profile_cycles_to_us(slot.exec_max);
+    out->exec_mean = slot.count ? profile_cycles_to_us((uint32_t)(slot.exec_sum / slot.count)) : 0;
+    out->wait_min = slot.count ? profile_cycles_to_us(slot.wait_min) : 0;
+    out->wait_max = profile_cycles_to_us(slot.wait_max);
+    out->wait_mean = slot.count ? profile_cycles_to_us((uint32_t)(slot.wait_sum / slot.count)) : 0;
+    memcpy(out->exec_hist, slot.exec_hist, sizeof(out->exec_hist));
+    memcpy(out->wait_hist, slot.wait_hist, sizeof(out->wait_hist));
+    return true;
 }
+#endif
 
-int worker_flush(uint32_t timeout_ms)
+/**
+ * @brief 向导出缓冲区追加格式化文本
+ * @return 追加后的长度，空间不足或之前已失败时返回-1
+ */
+static int profile_dump_append(char *buf, size_t size, int len, const char *fmt, ...)
 {
-    if (g_worker.magic != WORKER_MAGIC)
+    if (len < 0)
+    {
+        return -1;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, size - len, fmt, args);
+    va_end(args);
+
+    if (n < 0 || (size_t)(len + n) >= size)
     {
         return -1;
     }
+    return len + n;
+}
+
+uint32_t worker_profile_get(worker_profile_entry_t *entries, uint32_t max)
+{
+    uint32_t n = 0;
+
+#if WORKER_PROFILE_ENABLE
+    while (entries && n < max && worker_profile_copy(n, &entries[n]))
+    {
+        n++;
+    }
+#endif
+
+    return n;
+}
+
+int worker_profile_dump(char *buf, size_t size)
+{
+    if (!buf || size == 0)
+    {
+        return 0;
+    }
 
-    // 检查队列是否已经为空
-    uint32_t queue_length = uxQueueMessagesWaiting(g_worker.work_queue);
-    if (queue_length == 0)
+    buf[0] = '\0';
+    int len = profile_dump_append(buf, size, 0, "name,count,exec_min,exec_mean,exec_max,"
+                                                "wait_min,wait_mean,wait_max,exec_hist,wait_hist\n");
+    if (len < 0)
     {
+        buf[0] = '\0';
         return 0;
     }
 
-    // 设置刷新请求
-    g_worker.flush_requested = true;
+#if WORKER_PROFILE_ENABLE
+    worker_profile_entry_t e;
+    for (uint32_t i = 0; len >= 0 && worker_profile_copy(i, &e); i++)
+    {
+        int line_start = len;
+
+        len = profile_dump_append(buf, size, len, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+                                  e.name,
+                                  (unsigned long)e.count,
+                                  (unsigned long)e.exec_min,
+                                  (unsigned long)e.exec_mean,
+                                  (unsigned long)e.exec_max,
+                                  (unsigned long)e.wait_min,
+                                  (unsigned long)e.wait_mean,
+                                  (unsigned long)e.wait_max);
+        for (uint32_t b = 0; b < WORKER_PROFILE_HIST_BINS; b++)
+        {
+            len = profile_dump_append(buf, size, len, "%c%u", b ? '|' : ',', e.exec_hist[b]);
+        }
+        for (uint32_t b = 0; b < WORKER_PROFILE_HIST_BINS; b++)
+        {
+            len = profile_dump_append(buf, size, len, "%c%u", b ? '|' : ',', e.wait_hist[b]);
+        }
+        len = profile_dump_append(buf, size, len, "\n");
+
+        if (len < 0)
+        {
+            // 缓冲区不足，丢弃不完整的行
+            buf[line_start] = '\0';
+            return line_start;
+        }
+    }
+#endif
 
-    // 等待刷新完成
-    BaseType_t result = xSemaphoreTake(g_worker.flush_sem,
-                                       pdMS_TO_TICKS(timeout_ms));
+    return len;
+}
 
-    return (result == pdTRUE) ? 0 : -1;
+void worker_profile_reset(void)
+{
+#if WORKER_PROFILE_ENABLE
+    taskENTER_CRITICAL();
+    memset(g_profile.slots, 0, sizeof(g_profile.slots));
+    g_profile.used = 0;
+    g_profile.generation++;
+    taskEXIT_CRITICAL();
+#endif
 }
 
-worker_state_t worker_get_state(void)
+worker_state_t workqueue_get_state(const worker_t *w)
 {
-    if (g_worker.magic != WORKER_MAGIC)
+    if (!w || w->magic != WORKER_MAGIC)
     {
         return WORKER_STATE_ERROR;
     }
 
-    return g_worker.state;
+    return w->state;
 }
 
-void worker_print_status(void)
+worker_state_t worker_get_state(void)
+{
+    return workqueue_get_state(&g_default_worker);
+}
+
+void workqueue_print_status(const worker_t *w)
 {
-    if (g_worker.magic != WORKER_MAGIC)
+    if (!w || w->magic != WORKER_MAGIC)
     {
         printf("Worker not initialized\n");
         return;
     }
 
-    printf("=== Worker Thread Status ===\n");
+    printf("=== Worker '%s' Status ===\n", w->name);
     printf("State: %s\n",
-           g_worker.state == WORKER_STATE_RUNNING ? "RUNNING" : g_worker.state == WORKER_STATE_SUSPENDED ? "SUSPENDED"
-                                                            : g_worker.state == WORKER_STATE_STOPPED     ? "STOPPED"
-                                                                                                         : "ERROR");
+           w->state == WORKER_STATE_RUNNING ? "RUNNING" : w->state == WORKER_STATE_SUSPENDED ? "SUSPENDED"
+                                                    : w->state == WORKER_STATE_STOPPED     ? "STOPPED"
+                                                                                           : "ERROR");
 
-    UBaseType_t messages_waiting = uxQueueMessagesWaiting(g_worker.work_queue);
-    UBaseType_t queue_spaces = uxQueueSpacesAvailable(g_worker.work_queue);
-    UBaseType_t queue_length = messages_waiting + queue_spaces;
+    printf("Queue length: %lu/%lu, high water: %lu\n",
+           (unsigned long)w->pending,
+           (unsigned long)w->item_num,
+           (unsigned long)w->high_water);
+    printf("Accepted: %lu, dropped: %lu, coalesced: %lu\n",
+           (unsigned long)w->accepted,
+           (unsigned long)w->dropped,
+           (unsigned long)w->coalesced);
+    printf("ISR ring: %lu/%u, dropped: %lu\n",
+           (unsigned long)(w->isr_ring.enqueue_pos - w->isr_ring.dequeue_pos),
+           WORKER_ISR_RING_SIZE,
+           (unsigned long)w->isr_dropped);
+    printf("Deadline queue: %lu, missed: %lu\n",
+           (unsigned long)w->edf.count,
+           (unsigned long)w->deadline_missed);
+    printf("Threads: %u\n", w->thread_num);
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        const worker_thread_t *t = &w->threads[i];
+        printf("  [%u] queued: %lu, executed: %lu, stolen: %lu, wakeups: %lu, busy: %lu ms%s\n",
+               i,
+               (unsigned long)t->queued,
+               (unsigned long)t->executed,
+               (unsigned long)t->stolen,
+               (unsigned long)t->wakeups,
+               (unsigned long)(worker_busy_to_us(t->busy_time) / 1000U),
+               t->busy ? " (busy)" : "");
+    }
 
-    printf("Queue length: %lu/%lu\n",
-           (unsigned long)messages_waiting,
-           (unsigned long)queue_length);
+#if WORKER_PROFILE_ENABLE
+    // 剖析统计表按名称汇总，所有工作队列共用
+    worker_profile_entry_t entry;
+    printf("Profile (us):     count  exec min/mean/max        wait min/mean/max\n");
+    for (uint32_t i = 0; worker_profile_copy(i, &entry); i++)
+    {
+        printf("  %-14s %7lu  %6lu/%6lu/%6lu  %6lu/%6lu/%6lu\n",
+               entry.name,
+               (unsigned long)entry.count,
+               (unsigned long)entry.exec_min,
+               (unsigned long)entry.exec_mean,
+               (unsigned long)entry.exec_max,
+               (unsigned long)entry.wait_min,
+               (unsigned long)entry.wait_mean,
+               (unsigned long)entry.wait_max);
+    }
+#endif
     printf("Free heap: %u bytes\n", xPortGetFreeHeapSize());
 }
 
+void worker_print_status(void)
+{
+    workqueue_print_status(&g_default_worker);
+}
+
+int workqueue_get_stats(const worker_t *w, worker_stats_t *stats)
+{
+    if (!w || w->magic != WORKER_MAGIC || !stats)
+    {
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    taskENTER_CRITICAL();
+    stats->thread_num = w->thread_num;
+    stats->item_num = w->item_num;
+    stats->queue_length = w->pending + w->isr_work_count +
+                          (w->isr_ring.enqueue_pos - w->isr_ring.dequeue_pos);
+    uint64_t busy_time = 0;
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        stats->executed += w->threads[i].executed;
+        stats->stolen += w->threads[i].stolen;
+        stats->wakeups += w->threads[i].wakeups;
+        busy_time += w->threads[i].busy_time;
+    }
+    stats->high_water = w->high_water;
+    stats->accepted = w->accepted;
+    stats->dropped = w->dropped;
+    stats->coalesced = w->coalesced;
+    stats->isr_dropped = w->isr_dropped;
+    stats->deadline_missed = w->deadline_missed;
+    taskEXIT_CRITICAL();
+
+    // 空闲时间 = 运行时间 × 线程数 - 忙碌时间
+    stats->uptime_ms = (uint32_t)((uint64_t)(xTaskGetTickCount() - w->start_tick) * 1000U / configTICK_RATE_HZ);
+    stats->busy_ms = (uint32_t)(worker_busy_to_us(busy_time) / 1000U);
+    uint64_t total_ms = (uint64_t)stats->uptime_ms * w->thread_num;
+    stats->idle_ms = (total_ms > stats->busy_ms) ? (uint32_t)(total_ms - stats->busy_ms) : 0;
+
+    return 0;
+}
+
+int worker_get_stats(worker_stats_t *stats)
+{
+    return workqueue_get_stats(&g_default_worker, stats);
+}
+
+uint32_t workqueue_get_queue_length(const worker_t *w)
+{
+    if (!w || w->magic != WORKER_MAGIC)
+    {
+        return 0;
+    }
+
+    return w->pending + w->isr_work_count +
+           (w->isr_ring.enqueue_pos - w->isr_ring.dequeue_pos);
+}
+
 uint32_t worker_get_queue_length(void)
 {
-    if (g_worker.magic != WORKER_MAGIC)
+    return workqueue_get_queue_length(&g_default_worker);
+}
+
+uint32_t workqueue_get_thread_num(const worker_t *w)
+{
+    if (!w || w->magic != WORKER_MAGIC)
     {
         return 0;
     }
 
-    return uxQueueMessagesWaiting(g_worker.work_queue);
+    return w->thread_num;
 }
 
-int worker_suspend(void)
+uint32_t worker_get_thread_num(void)
 {
-    if (g_worker.magic != WORKER_MAGIC)
+    return workqueue_get_thread_num(&g_default_worker);
+}
+
+uint32_t workqueue_get_deadline_misses(const worker_t *w)
+{
+    if (!w || w->magic != WORKER_MAGIC)
+    {
+        return 0;
+    }
+
+    return w->deadline_missed;
+}
+
+uint32_t worker_get_deadline_misses(void)
+{
+    return workqueue_get_deadline_misses(&g_default_worker);
+}
+
+void worker_set_deadline_miss_callback(worker_deadline_miss_cb_t cb)
+{
+    g_deadline_miss_cb = cb;
+}
+
+int workqueue_suspend(worker_t *w)
+{
+    // 工作线程不能等待自己暂停
+    if (!w || w->magic != WORKER_MAGIC || current_worker_thread(w))
     {
         return -1;
     }
 
-    vTaskSuspend(g_worker.task_handle);
-    g_worker.state = WORKER_STATE_SUSPENDED;
+    if (w->ctrl & WORKER_CTRL_SUSPEND)
+    {
+        return 0;
+    }
+
+    // 线程执行完当前一批工作项后停下并应答，返回时已没有工作项在执行
+    worker_post_ctrl(w, WORKER_CTRL_SUSPEND, 0);
+    for (uint8_t i = 0; i < w->thread_num; i++)
+    {
+        xSemaphoreTake(w->ctrl_sem, portMAX_DELAY);
+    }
+    w->state = WORKER_STATE_SUSPENDED;
 
     return 0;
 }
 
-int worker_resume(void)
+int worker_suspend(void)
 {
-    if (g_worker.magic != WORKER_MAGIC)
+    return workqueue_suspend(&g_default_worker);
+}
+
+int workqueue_resume(worker_t *w)
+{
+    if (!w || w->magic != WORKER_MAGIC)
     {
         return -1;
     }
 
-    vTaskResume(g_worker.task_handle);
-    g_worker.state = WORKER_STATE_RUNNING;
+    w->state = WORKER_STATE_RUNNING;
+    worker_post_ctrl(w, 0, WORKER_CTRL_SUSPEND);
 
     return 0;
-}
\ No newline at end of file
+}
+
+int worker_resume(void)
+{
+    return workqueue_resume(&g_default_worker);
+}
@@ -0,0 +1,369 @@
+#include "worker_coro.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+// 等待状态位（只由协程自身的执行步骤修改）
+#define CORO_WAIT_DEADLINE 0x01 // 本次等待有超时
+#define CORO_WAIT_TIMER 0x02    // 超时定时已挂上时间轮
+#define CORO_WAIT_TIMEOUT 0x04  // 上一次等待因超时结束
+
+// 执行状态位（临界区内修改）
+#define CORO_EXEC_BUSY 0x01  // 正在某个工作线程上执行
+#define CORO_EXEC_AGAIN 0x02 // 执行期间被其他线程再次调度，执行完后继续
+
+/**
+ * @brief tick转换为毫秒（向上取整，保证定时不早于截止时间）
+ */
+static uint32_t coro_ticks_to_ms(TickType_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * 1000U + configTICK_RATE_HZ - 1) / configTICK_RATE_HZ);
+}
+
+/**
+ * @brief 从信号量等待链表中移除协程（调用者持有临界区）
+ * @return 移除后需要唤醒的下一个等待者（信号量有余量时），否则NULL
+ */
+static worker_coro_t *sem_remove_waiter(worker_sem_t *sem, worker_coro_t *co)
+{
+    worker_coro_t **pp = &sem->waiters;
+
+    while (*pp)
+    {
+        if (*pp == co)
+        {
+            *pp = co->wait_next;
+            break;
+        }
+        pp = &(*pp)->wait_next;
+    }
+    co->wait_next = NULL;
+    co->wait_sem = NULL;
+
+    return (sem->count > 0) ? sem->waiters : NULL;
+}
+
+/**
+ * @brief 协程结束或取消后的清理：撤销超时定时和信号量等待
+ */
+static void coro_release(worker_coro_t *co)
+{
+    worker_timer_cancel(&co->timer);
+    co->wait_flags &= (uint8_t)~CORO_WAIT_TIMER;
+
+    worker_sem_t *sem = co->wait_sem;
+    if (sem)
+    {
+        worker_sem_cancel_wait(sem, co);
+    }
+}
+
+/**
+ * @brief 协程执行一步（恢复工作的回调）
+ *
+ * 协程的恢复工作可能被唤醒、超时和让出多次提交，多线程工作队列上同一工作对象
+ * 可能同时被两个线程取出，这里保证同一时刻只有一个线程执行协程函数，
+ * 其余的调度合并为执行完后再运行一次。
+ */
+static void worker_coro_step(void *arg)
+{
+    worker_coro_t *co = (worker_coro_t *)arg;
+
+    taskENTER_CRITICAL();
+    if (co->exec_flags & CORO_EXEC_BUSY)
+    {
+        co->exec_flags |= CORO_EXEC_AGAIN;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    co->exec_flags = CORO_EXEC_BUSY;
+    taskEXIT_CRITICAL();
+
+    for (;;)
+    {
+        if (co->state != WORKER_CORO_RUNNING)
+        {
+            // 已取消，丢弃剩余的调度
+            coro_release(co);
+            taskENTER_CRITICAL();
+            co->exec_flags = 0;
+            taskEXIT_CRITICAL();
+            return;
+        }
+
+        int ret = co->fn(co, co->arg);
+
+        if (ret == WORKER_CORO_EXITED || ret == WORKER_CORO_ENDED)
+        {
+            co->lc = 0;
+            co->state = WORKER_CORO_DONE;
+            coro_release(co);
+        }
+        else if (ret == WORKER_CORO_YIELDED && co->state == WORKER_CORO_RUNNING)
+        {
+            workqueue_queue_work(co->wq, &co->timer.work);
+        }
+
+        taskENTER_CRITICAL();
+        if (!(co->exec_flags & CORO_EXEC_AGAIN))
+        {
+            co->exec_flags = 0;
+            taskEXIT_CRITICAL();
+            return;
+        }
+        co->exec_flags = CORO_EXEC_BUSY;
+        taskEXIT_CRITICAL();
+    }
+}
+
+void worker_coro_init(worker_coro_t *co, worker_coro_fn_t fn, void *arg, const char *name)
+{
+    if (!co)
+    {
+        return;
+    }
+
+    memset(co, 0, sizeof(*co));
+    worker_timer_init(&co->timer, worker_coro_step, co, name);
+    co->fn = fn;
+    co->arg = arg;
+    co->state = WORKER_CORO_IDLE;
+}
+
+int workqueue_coro_start(worker_t *wq, worker_coro_t *co)
+{
+    if (!wq || !co || !co->fn || co->state == WORKER_CORO_RUNNING)
+    {
+        return -1;
+    }
+
+    co->wq = wq;
+    co->lc = 0;
+    co->wait_flags = 0;
+    co->wait_next = NULL;
+    co->wait_sem = NULL;
+    co->state = WORKER_CORO_RUNNING;
+
+    if (workqueue_queue_work(wq, &co->timer.work) < 0)
+    {
+        co->state = WORKER_CORO_IDLE;
+        return -1;
+    }
+
+    return 0;
+}
+
+int worker_coro_start(worker_coro_t *co)
+{
+    return workqueue_coro_start(workqueue_get_default(), co);
+}
+
+int worker_coro_wake(worker_coro_t *co)
+{
+    if (!co || co->state != WORKER_CORO_RUNNING)
+    {
+        return -1;
+    }
+
+    return workqueue_queue_work(co->wq, &co->timer.work);
+}
+
+int worker_coro_wake_from_isr(worker_coro_t *co, BaseType_t *higher_prio_woken)
+{
+    if (!co || co->state != WORKER_CORO_RUNNING)
+    {
+        return -1;
+    }
+
+    return workqueue_queue_work_from_isr(co->wq, &co->timer.work, higher_prio_woken);
+}
+
+int worker_coro_cancel(worker_coro_t *co)
+{
+    if (!co || co->state != WORKER_CORO_RUNNING)
+    {
+        return -1;
+    }
+
+    co->state = WORKER_CORO_DONE;
+    coro_release(co);
+
+    return 0;
+}
+
+worker_coro_state_t worker_coro_get_state(const worker_coro_t *co)
+{
+    return co ? (worker_coro_state_t)co->state : WORKER_CORO_IDLE;
+}
+
+bool worker_coro_timed_out(const worker_coro_t *co)
+{
+    return co && (co->wait_flags & CORO_WAIT_TIMEOUT);
+}
+
+void worker_coro_wait_begin(worker_coro_t *co, uint32_t timeout_ms)
+{
+    co->wait_flags = 0;
+    if (timeout_ms != WORKER_CORO_FOREVER)
+    {
+        co->deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+        co->wait_flags = CORO_WAIT_DEADLINE;
+    }
+}
+
+bool worker_coro_wait_expired(worker_coro_t *co)
+{
+    if (!(co->wait_flags & CORO_WAIT_DEADLINE))
+    {
+        return false;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    TickType_t remain = co->deadline - now;
+    if (remain == 0 || remain > portMAX_DELAY / 2)
+    {
+        co->wait_flags |= CORO_WAIT_TIMEOUT;
+        return true;
+    }
+
+    // 第一次进入等待时才挂超时定时，条件立即成立的等待不碰时间轮
+    if (!(co->wait_flags & CORO_WAIT_TIMER))
+    {
+        co->wait_flags |= CORO_WAIT_TIMER;
+        workqueue_send_delayed(co->wq, &co->timer, coro_ticks_to_ms(remain));
+    }
+
+    return false;
+}
+
+void worker_coro_wait_end(worker_coro_t *co)
+{
+    if (co->wait_flags & CORO_WAIT_TIMER)
+    {
+        worker_timer_cancel(&co->timer);
+        co->wait_flags &= (uint8_t)~CORO_WAIT_TIMER;
+    }
+    co->wait_flags &= (uint8_t)~CORO_WAIT_DEADLINE;
+}
+
+void worker_sem_init(worker_sem_t *sem, uint32_t initial, uint32_t max_count)
+{
+    if (!sem)
+    {
+        return;
+    }
+
+    sem->max_count = max_count ? max_count : 1;
+    sem->count = (initial > sem->max_count) ? sem->max_count : initial;
+    sem->waiters = NULL;
+}
+
+bool worker_coro_sem_poll(worker_coro_t *co, worker_sem_t *sem)
+{
+    worker_coro_t *next = NULL;
+    bool taken = false;
+
+    taskENTER_CRITICAL();
+    if (sem->count > 0 && (!sem->waiters || sem->waiters == co))
+    {
+        // 轮到本协程（先进先出）
+        sem->count--;
+        if (co->wait_sem == sem)
+        {
+            next = sem_remove_waiter(sem, co);
+        }
+        taken = true;
+    }
+    else if (co->wait_sem != sem)
+    {
+        // 加入等待链表尾部
+        worker_coro_t **pp = &sem->waiters;
+        while (*pp)
+        {
+            pp = &(*pp)->wait_next;
+        }
+        co->wait_next = NULL;
+        *pp = co;
+        co->wait_sem = sem;
+    }
+    taskEXIT_CRITICAL();
+
+    // 还有余量时把机会交给下一个等待者
+    if (next)
+    {
+        worker_coro_wake(next);
+    }
+
+    return taken;
+}
+
+void worker_sem_cancel_wait(worker_sem_t *sem, worker_coro_t *co)
+{
+    worker_coro_t *next = NULL;
+
+    taskENTER_CRITICAL();
+    if (co->wait_sem == sem)
+    {
+        next = sem_remove_waiter(sem, co);
+    }
+    taskEXIT_CRITICAL();
+
+    if (next)
+    {
+        worker_coro_wake(next);
+    }
+}
+
+int worker_sem_give(worker_sem_t *sem)
+{
+    if (!sem)
+    {
+        return -1;
+    }
+
+    worker_coro_t *head;
+
+    taskENTER_CRITICAL();
+    if (sem->count >= sem->max_count)
+    {
+        taskEXIT_CRITICAL();
+        return -1;
+    }
+    sem->count++;
+    head = sem->waiters;
+    taskEXIT_CRITICAL();
+
+    if (head)
+    {
+        worker_coro_wake(head);
+    }
+
+    return 0;
+}
+
+int worker_sem_give_from_isr(worker_sem_t *sem, BaseType_t *higher_prio_woken)
+{
+    if (!sem)
+    {
+        return -1;
+    }
+
+    worker_coro_t *head;
+
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    if (sem->count >= sem->max_count)
+    {
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+        return -1;
+    }
+    sem->count++;
+    head = sem->waiters;
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if (head)
+    {
+        worker_coro_wake_from_isr(head, higher_prio_woken);
+    }
+
+    return 0;
+}
@@ -7,11 +7,14 @@
  */
 
 #include "worker.h"
+#include "worker_coro.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include "compile.h"
 // 示例数据结构
 typedef struct
 {
@@ -221,20 +224,33 @@ void worker_batch_example(void)
 {
     printf("=== Batch Worker Example ===\n");
 
-    const int batch_size = 10;
+    worker_queue_item_t items[10];
+    const int batch_size = sizeof(items) / sizeof(items[0]);
+    int count = 0;
 
-    // 提交一批网络发送任务
+    // 准备一批网络发送任务
     for (int i = 0; i < batch_size; i++)
     {
         char *message = pvPortMalloc(64);
         if (message)
         {
             snprintf(message, 64, "Batch message #%d", i + 1);
-            WORKER_SUBMIT(network_send_work, message);
+            items[count++] = (worker_queue_item_t){
+                .cb = network_send_work,
+                .arg = message,
+                .flags = WORKER_FLAG_NONE,
+                .name = "network_send_work"};
         }
     }
 
-    printf("Submitted %d batch tasks\n", batch_size);
+    // 一次提交整批任务，未放入的部分释放
+    int sent = worker_send_batch(items, count);
+    for (int i = (sent < 0) ? 0 : sent; i < count; i++)
+    {
+        vPortFree(items[i].arg);
+    }
+
+    printf("Submitted %d/%d batch tasks\n", sent, count);
 
     // 等待所有任务完成
     printf("Waiting for all tasks to complete...\n");
@@ -248,6 +264,41 @@ void worker_batch_example(void)
     }
 }
 
+/**
+ * @brief 等待单个工作项完成的示例
+ *
+ * 只关心某一项是否完成时用完成句柄，不必刷新整个队列。
+ */
+void worker_future_example(void)
+{
+    printf("=== Worker Future Example ===\n");
+
+    static worker_future_t monitor_done = WORKER_FUTURE_INIT;
+    worker_queue_item_t item = {
+        .cb = system_monitor_work,
+        .arg = NULL,
+        .flags = WORKER_FLAG_HIGH_PRIO,
+        .name = "SystemMonitor",
+        .future = &monitor_done};
+
+    if (worker_send(&item) != 0)
+    {
+        printf("Queue full\n");
+        return;
+    }
+
+    // 等待期间本任务阻塞，完成时立即被唤醒
+    if (worker_future_wait(&monitor_done, 1000) == 0)
+    {
+        printf("System monitor finished\n");
+    }
+    else
+    {
+        // 超时后future仍被工作项引用（static存储，保持有效）
+        printf("System monitor still pending\n");
+    }
+}
+
 /**
  * @brief Worker状态监控示例
  */
@@ -270,6 +321,34 @@ void worker_monitoring_example(void)
                                                                                        : "ERROR");
 }
 
+/**
+ * @brief 空闲唤醒率和利用率测量示例
+ *
+ * 工作线程由事件驱动，空闲且没有定时对象时不会醒来（原实现每个线程每50ms轮询一次，
+ * 即20次/秒），可以让系统进入tickless低功耗。
+ */
+void worker_idle_wakeup_example(void)
+{
+    printf("=== Worker Idle Wakeup Example ===\n");
+
+    worker_stats_t before;
+    worker_stats_t after;
+
+    if (worker_get_stats(&before) != 0)
+    {
+        printf("Worker not initialized\n");
+        return;
+    }
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    worker_get_stats(&after);
+
+    uint32_t busy = after.busy_ms - before.busy_ms;
+    uint32_t idle = after.idle_ms - before.idle_ms;
+    printf("Wakeups: %lu/s, utilization: %lu%%\n",
+           (unsigned long)(after.wakeups - before.wakeups),
+           (unsigned long)((busy + idle) ? busy * 100 / (busy + idle) : 0));
+}
+
 /**
  * @brief 完整的worker使用示例
  */
@@ -306,6 +385,437 @@ void worker_complete_example(void)
     printf("Worker examples completed\n");
 }
 
+// =============================================================================
+// 多工作队列示例
+// =============================================================================
+
+/**
+ * @brief 创建高优先级I/O队列和低优先级批量队列
+ *
+ * I/O队列深度小、优先级高，只放短小的收发处理；日志落盘、统计等耗时任务放入批量队列，
+ * 不会拖慢I/O处理，两个队列的统计分别查看。
+ */
+// 节点池和线程栈（WORKER_STATIC_ALLOC模式下使用，动态模式下忽略）
+WORKER_STATIC_STORAGE(io_wq, 1, 8, 1024);
+WORKER_STATIC_STORAGE(bulk_wq, 1, 32, 2048);
+
+void worker_multi_queue_example(void)
+{
+    printf("=== Worker Multi Queue Example ===\n");
+
+    static const worker_config_t io_config = {
+        .name = "io_wq",
+        .thread_num = 1,
+        .item_num = 8,
+        .stack_size = 1024,
+        .priority = 10,
+        .nodes = io_wq_nodes,
+        .stacks = io_wq_stacks};
+    static const worker_config_t bulk_config = {
+        .name = "bulk_wq",
+        .thread_num = 1,
+        .item_num = 32,
+        .stack_size = 2048,
+        .priority = 2,
+        .nodes = bulk_wq_nodes,
+        .stacks = bulk_wq_stacks};
+
+    worker_t *io_wq = workqueue_create(&io_config);
+    worker_t *bulk_wq = workqueue_create(&bulk_config);
+    if (!io_wq || !bulk_wq)
+    {
+        printf("Failed to create workqueues\n");
+        workqueue_delete(io_wq);
+        workqueue_delete(bulk_wq);
+        return;
+    }
+
+    led_control_t *led = pvPortMalloc(sizeof(led_control_t));
+    if (led)
+    {
+        led->led_id = 1;
+        led->state = true;
+
+        worker_queue_item_t led_item = {
+            .cb = led_control_work,
+            .arg = led,
+            .flags = WORKER_FLAG_NONE,
+            .name = "LedControl"};
+        if (workqueue_send(io_wq, &led_item) != 0)
+        {
+            vPortFree(led);
+        }
+    }
+
+    worker_queue_item_t monitor_item = {
+        .cb = system_monitor_work,
+        .arg = NULL,
+        .flags = WORKER_FLAG_NONE,
+        .name = "SystemMonitor"};
+    workqueue_send(bulk_wq, &monitor_item);
+
+    workqueue_flush(io_wq, 1000);
+    workqueue_flush(bulk_wq, 5000);
+
+    workqueue_print_status(io_wq);
+    workqueue_print_status(bulk_wq);
+
+    workqueue_delete(io_wq);
+    workqueue_delete(bulk_wq);
+}
+
+// =============================================================================
+// 协程示例：大量并发传感器事务共用worker线程的栈
+// =============================================================================
+
+#define CORO_SENSOR_NUM 24
+
+// 每个传感器事务的状态（协程局部变量不跨等待保留，状态都放在这里）
+typedef struct
+{
+    worker_coro_t co;
+    worker_timer_t xfer; // 模拟总线传输，实际项目中由DMA完成中断调用worker_coro_wake_from_isr
+    volatile bool xfer_done;
+    uint8_t sensor_id;
+    uint8_t round;
+    uint16_t value;
+    uint32_t timeouts;
+} coro_sensor_t;
+
+static coro_sensor_t coro_sensors[CORO_SENSOR_NUM];
+static worker_sem_t coro_bus_sem; // 共享总线，同一时刻只允许一次传输
+
+static void coro_sensor_xfer_done(void *arg)
+{
+    coro_sensor_t *s = (coro_sensor_t *)arg;
+    s->value = (uint16_t)(s->sensor_id * 100 + s->round);
+    s->xfer_done = true;
+    worker_coro_wake(&s->co);
+}
+
+static int coro_sensor_flow(worker_coro_t *co, void *arg)
+{
+    coro_sensor_t *s = (coro_sensor_t *)arg;
+
+    WORKER_CORO_BEGIN(co);
+
+    for (s->round = 0; s->round < 3; s->round++)
+    {
+        // 获取总线
+        WORKER_CORO_SEM_TAKE(co, &coro_bus_sem, 500);
+        if (worker_coro_timed_out(co))
+        {
+            s->timeouts++;
+            continue;
+        }
+
+        // 启动传输并等待完成
+        s->xfer_done = false;
+        worker_send_delayed(&s->xfer, 2);
+        WORKER_CORO_WAIT_UNTIL(co, s->xfer_done, 20);
+        worker_sem_give(&coro_bus_sem);
+        if (worker_coro_timed_out(co))
+        {
+            s->timeouts++;
+            continue;
+        }
+
+        // 采样间隔
+        WORKER_CORO_DELAY(co, 10 + s->sensor_id);
+    }
+
+    WORKER_CORO_END(co);
+}
+
+/**
+ * @brief 协程示例
+ *
+ * 24个传感器事务各自排队等总线、等传输完成、延时，全部在默认worker上运行，
+ * 不需要为每个事务创建任务和栈。
+ */
+void worker_coro_example(void)
+{
+    printf("=== Worker Coroutine Example ===\n");
+
+    worker_sem_init(&coro_bus_sem, 1, 1);
+    for (int i = 0; i < CORO_SENSOR_NUM; i++)
+    {
+        coro_sensor_t *s = &coro_sensors[i];
+        memset(s, 0, sizeof(*s));
+        s->sensor_id = (uint8_t)i;
+        worker_timer_init(&s->xfer, coro_sensor_xfer_done, s, "SensorXfer");
+        worker_coro_init(&s->co, coro_sensor_flow, s, "SensorFlow");
+        worker_coro_start(&s->co);
+    }
+
+    // 等待所有事务结束
+    for (int i = 0; i < CORO_SENSOR_NUM; i++)
+    {
+        while (worker_coro_get_state(&coro_sensors[i].co) == WORKER_CORO_RUNNING)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        printf("sensor %2d: last value %u, timeouts %lu\n", i,
+               coro_sensors[i].value, (unsigned long)coro_sensors[i].timeouts);
+    }
+}
+
+// =============================================================================
+// 线程池性能测试
+// =============================================================================
+
+#define POOL_BENCH_ITEMS 1000
+#define POOL_BENCH_SLOW_EVERY 16 // 每16个任务中有一个慢任务（模拟flash擦除）
+
+static uint32_t pool_bench_submit[POOL_BENCH_ITEMS];
+static uint32_t pool_bench_latency[POOL_BENCH_ITEMS];
+
+/**
+ * @brief 测试任务：记录排队延迟，慢任务阻塞2ms
+ */
+static void pool_bench_work(void *arg)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)arg;
+
+    pool_bench_latency[idx] = dwt_get_cycles() - pool_bench_submit[idx];
+
+    if (idx % POOL_BENCH_SLOW_EVERY == 0)
+    {
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    else
+    {
+        volatile uint32_t spin = 200;
+        while (spin--)
+        {
+        }
+    }
+}
+
+static int pool_bench_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void pool_bench_run(int thread_num)
+{
+    if (worker_pool_init(thread_num, 32, 1536, 8) != 0)
+    {
+        printf("Failed to initialize worker pool with %d threads\n", thread_num);
+        return;
+    }
+
+    uint32_t freq = get_system_clock_freq();
+    uint32_t start = dwt_get_cycles();
+
+    for (uint32_t i = 0; i < POOL_BENCH_ITEMS; i++)
+    {
+        worker_queue_item_t item = {
+            .cb = pool_bench_work,
+            .arg = (void *)(uintptr_t)i,
+            .flags = WORKER_FLAG_NONE,
+            .name = "pool_bench"};
+
+        pool_bench_submit[i] = dwt_get_cycles();
+        worker_send_timeout(&item, 1000);
+    }
+
+    worker_flush(30000);
+    uint32_t total_cycles = dwt_get_cycles() - start;
+    worker_thread_destroy();
+
+    qsort(pool_bench_latency, POOL_BENCH_ITEMS, sizeof(uint32_t), pool_bench_cmp);
+
+    uint32_t total_ms = (uint32_t)(cycles_to_ns(total_cycles, freq) / 1000000);
+    uint32_t p50_us = (uint32_t)(cycles_to_ns(pool_bench_latency[POOL_BENCH_ITEMS / 2], freq) / 1000);
+    uint32_t p99_us = (uint32_t)(cycles_to_ns(pool_bench_latency[POOL_BENCH_ITEMS * 99 / 100], freq) / 1000);
+    uint32_t max_us = (uint32_t)(cycles_to_ns(pool_bench_latency[POOL_BENCH_ITEMS - 1], freq) / 1000);
+
+    printf("[POOL] threads=%d items=%d time=%lu ms throughput=%lu items/s latency p50=%lu us p99=%lu us max=%lu us\n",
+           thread_num, POOL_BENCH_ITEMS,
+           (unsigned long)total_ms,
+           (unsigned long)(total_ms ? POOL_BENCH_ITEMS * 1000UL / total_ms : 0),
+           (unsigned long)p50_us,
+           (unsigned long)p99_us,
+           (unsigned long)max_us);
+}
+
+/**
+ * @brief 线程池吞吐量和尾延迟测试（1/2/4个工作线程）
+ *
+ * 测试会独占worker，运行前先销毁已初始化的默认worker。
+ * 需要先调用dwt_init()。
+ */
+void worker_pool_benchmark_example(void)
+{
+    printf("=== Worker Pool Benchmark ===\n");
+
+    worker_thread_destroy();
+
+    const int thread_nums[] = {1, 2, 4};
+    for (size_t i = 0; i < sizeof(thread_nums) / sizeof(thread_nums[0]); i++)
+    {
+        pool_bench_run(thread_nums[i]);
+    }
+}
+
+// =============================================================================
+// 批量提交开销测试
+// =============================================================================
+
+#define BATCH_BENCH_ITEMS 1000
+#define BATCH_BENCH_CHUNK 16
+
+static void batch_bench_work(void *arg)
+{
+    (void)arg;
+}
+
+/**
+ * @brief 对比逐项提交和批量提交的每项开销（提交侧周期数和总耗时）
+ *
+ * 测试会独占worker，运行前先销毁已初始化的默认worker。
+ * 需要先调用dwt_init()。
+ */
+void worker_batch_benchmark_example(void)
+{
+    static worker_queue_item_t items[BATCH_BENCH_CHUNK];
+
+    printf("=== Worker Batch Benchmark ===\n");
+
+    worker_thread_destroy();
+    if (worker_thread_init(64, 1536, 8) != 0)
+    {
+        printf("Failed to initialize worker\n");
+        return;
+    }
+
+    for (int i = 0; i < BATCH_BENCH_CHUNK; i++)
+    {
+        items[i] = (worker_queue_item_t){
+            .cb = batch_bench_work,
+            .arg = NULL,
+            .flags = WORKER_FLAG_NONE,
+            .name = "batch_bench"};
+    }
+
+    uint32_t freq = get_system_clock_freq();
+    for (int mode = 0; mode < 2; mode++)
+    {
+        uint32_t submit_cycles = 0;
+        uint32_t start = dwt_get_cycles();
+
+        for (int sent = 0; sent < BATCH_BENCH_ITEMS;)
+        {
+            uint32_t t0 = dwt_get_cycles();
+            int n;
+            if (mode == 0)
+            {
+                n = (worker_send(&items[0]) == 0) ? 1 : 0;
+            }
+            else
+            {
+                n = worker_send_batch(items, BATCH_BENCH_CHUNK);
+            }
+            submit_cycles += dwt_get_cycles() - t0;
+
+            if (n <= 0)
+            {
+                vTaskDelay(1); // 队列满，让worker消化
+                continue;
+            }
+            sent += n;
+        }
+        worker_flush(30000);
+        uint32_t total_cycles = dwt_get_cycles() - start;
+
+        printf("[BATCH] %-6s items=%d submit=%lu cycles/item total=%lu ns/item\n",
+               mode == 0 ? "single" : "batch",
+               BATCH_BENCH_ITEMS,
+               (unsigned long)(submit_cycles / BATCH_BENCH_ITEMS),
+               (unsigned long)(cycles_to_ns(total_cycles, freq) / BATCH_BENCH_ITEMS));
+    }
+
+    worker_thread_destroy();
+}
+
+// =============================================================================
+// 中断提交延迟测试
+// =============================================================================
+
+#define ISR_LAT_ROUNDS 200
+
+static volatile uint32_t isr_lat_submit;
+static uint32_t isr_lat_samples[ISR_LAT_ROUNDS];
+
+static void isr_lat_work(void *arg)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)arg;
+    isr_lat_samples[idx] = dwt_get_cycles() - isr_lat_submit;
+}
+
+/**
+ * @brief 测量提交到回调开始执行的周期数
+ * @param from_isr true: 在中断屏蔽区内调用worker_send_from_isr模拟ISR提交
+ */
+static void isr_lat_run(bool from_isr)
+{
+    uint32_t min = UINT32_MAX, max = 0;
+    uint64_t sum = 0;
+
+    for (uint32_t i = 0; i < ISR_LAT_ROUNDS; i++)
+    {
+        worker_queue_item_t item = {
+            .cb = isr_lat_work,
+            .arg = (void *)(uintptr_t)i,
+            .flags = WORKER_FLAG_HIGH_PRIO,
+            .name = "isr_lat"};
+
+        if (from_isr)
+        {
+            BaseType_t woken = pdFALSE;
+            UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+            isr_lat_submit = dwt_get_cycles();
+            worker_send_from_isr(&item, &woken);
+            taskEXIT_CRITICAL_FROM_ISR(saved);
+            portYIELD_FROM_ISR(woken);
+        }
+        else
+        {
+            isr_lat_submit = dwt_get_cycles();
+            worker_send(&item);
+        }
+
+        worker_flush(100);
+
+        uint32_t c = isr_lat_samples[i];
+        min = c < min ? c : min;
+        max = c > max ? c : max;
+        sum += c;
+    }
+
+    printf("[ISR_LAT] %-16s min=%lu avg=%lu max=%lu cycles\n",
+           from_isr ? "send_from_isr" : "send",
+           (unsigned long)min,
+           (unsigned long)(sum / ISR_LAT_ROUNDS),
+           (unsigned long)max);
+}
+
+/**
+ * @brief 对比worker_send与worker_send_from_isr的提交到执行延迟
+ *
+ * 需要先调用dwt_init()，worker需已初始化且空闲。
+ */
+void worker_isr_latency_example(void)
+{
+    printf("=== Worker ISR Latency ===\n");
+
+    isr_lat_run(false);
+    isr_lat_run(true);
+}
+
 // =============================================================================
 // 集成到你的项目中的建议
 // =============================================================================
@@ -99,6 +99,7 @@ void system_monitor_work(void *arg)
     LED_BLUE_TOGGLE();
     logw("system_monitor_work");
 }
+static worker_timer_t system_monitor_timer = WORKER_TIMER_INIT(system_monitor_work, NULL);
 FASTDATA static char *msg_fastdata1 = "01234567890";  // flash
 FASTDATA static char msg_fastdata2[] = "01234567890"; // 移除const，使用数组而非指针,否则会被放到.rodata中
 // 将FASTDATA变量移到函数外部
@@ -189,7 +190,6 @@ RAMFUNC void ram_func_test()
 }
 int app_main(void)
 {
-    int ret;
     // 首先初始化内存段 - 这必须在任何RAM函数被调用之前执行
     memory_sections_init();
 
@@ -215,17 +215,18 @@ int app_main(void)
     // ram_func_test();  //内部ram比内部flash快14%
 
     logi("=== Application Main Loop Started ===");
-    if ((ret = worker_thread_init(16, 2048, 4)) != 0)
+    // worker已由外设初始化框架启动（worker_thread_init_help）
+    if (worker_get_state() != WORKER_STATE_RUNNING)
     {
-        loge("worker_thread_init fail ret:%d", ret);
+        loge("worker not running state:%d", worker_get_state());
         error_handler("worker_thread_init fail");
     }
+    // 系统监控由worker时间轮周期执行
+    worker_send_periodic(&system_monitor_timer, 1000);
     uint32_t cycle_count = 0;
 
     while (1)
     {
-        WORKER_SUBMIT(system_monitor_work, NULL);
-
         osDelay(1000);
         cycle_count++;
         logi("Main loop cycle #%lu", cycle_count);